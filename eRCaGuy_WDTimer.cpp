@@ -5,11 +5,27 @@ By Gabriel Staples
 Website: http://electricrcaircraftguy.blogspot.com
 Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
 Written: 4 Aug 2014
-Updated: 5 Aug 2014
+Updated: 16 Oct 2026
 */
 
 /*
 History (newest on top)
+20261016 - the time stamps & durations are now fixed-width (uint32_t & int32_t, ie: the same unsigned long & long as before, on an AVR), so the PC simulator runs the same 32-bit arithmetic & roll-overs
+20261016 - added an optional low-power sampler (compiled in with WDT_SAMPLER 1): beginSampler() takes one ADC sample per period, in ADC noise reduction sleep, into a double buffer, & only wakes the user code up (batch handler, or readBatch()) once per full batch
+20261016 - added snapshot(), a tear-free copy of the attachInterrupt() timer's state which never turns interrupts off (seqlock style); the raw _t_WDT_*, _WDT_period & _WDT_mode members are now private; update_WDT_period() no longer toggles SREG
+20261016 - added absolute & phase-aligned timers, atTime() & everyAligned(), on a 64-bit time base (now64(), setNow()) which doesn't roll over
+20261016 - added supervision mode (beginSupervision()): the WDT reset stays armed behind the WDT interrupt, & registered tasks check in once per window with checkIn(); stalled tasks are recorded in .noinit RAM
+20261016 - added a per-timer overrun policy for _WDT_REPEAT timers (catch up, with a cap; skip & stay phase-aligned; or re-anchor), with missed & coalesced period counters; a call whose deadline went by while the user functions held the WDT ISR off (seen from the WDT's own pending interrupt) counts as missed
+20261016 - added an optional slack (tolerance) argument to attachInterrupt(), timedInterrupt() & addTimer(); each period then ends at the point within +/-slack which takes the fewest WDT wakeups, while the long term average period stays exact
+20261016 - added an optional fine mode (compiled in with WDT_FINE 1), which finishes each delay with a short Timer2 compare match instead of rounding it to 16ms, for sub-ms precision; delays from 1ms up are then valid
+20261016 - added optional timing statistics (compiled in with WDT_STATS 1): period error histogram, min/max/mean period, wakeups per period, user function run time & overruns, read with stats()
+20261016 - added an optional deferred mode (setDeferred()), in which the ISR only queues an event for each expired timer, & poll()/dispatch() run them later from loop()
+20261016 - added calibrate(), which measures every WDT delay against micros() (or any other us reference), plus EEPROM save/load of the results & background recalibration; the time base & update_WDT_period() now use the calibrated delay lengths
+20261016 - the timers now keep their own time base, now(), counted in WDT delays (which calibrate themselves against the crystal as they run, by default; see setBackgroundCalibration()), so they keep working while millis() is stopped (ex: in power-down sleep); added syncMillis()
+20261016 - added the WDTimer<PeriodMs> template, which plans a fixed period's chain of WDT delays at compile time, so the ISR just steps through a constant table
+20261016 - added an opt-in sleep() method, which sleeps (power-down by default) between WDT delay segments, with ADC/BOD/user hooks & awake-vs-asleep duty cycle reporting; it returns the time it slept
+20261016 - moved all WDT register & millis() accesses behind a thin HAL (eRCaGuy_WDTimer_HAL.h), so the library can run on a PC simulator (extras/host)
+20261016 - added a fixed-capacity, deadline-ordered timer queue (min-heap) so that many independent timers can share the single WDT_vect ISR
 20140805 - library first written
 */
 
@@ -75,11 +91,18 @@ WDTO_15MS     16 ms                16 ms               15.914 ms
 
 //Libraries to include
 #include "eRCaGuy_WDTimer.h"
-#include <avr/wdt.h>
+#include "eRCaGuy_WDTimer_HAL.h" //all access to the WDT hardware & to millis() goes through here
+#include <stddef.h> //for offsetof()
+#include <string.h> //for memset()
+#include <stdlib.h> //for labs()
 
 //pre-instantiate an object of this library class, for use within the ISR & by the user
 eRCaGuy_WDTimer wdt;
 
+//supervision mode record of the tasks which stalled (see superviseWindow()); in .noinit RAM, so it survives the reset
+static byte WDT_stalledTasks WDT_HAL_NOINIT;
+static byte WDT_stalledTasksCheck WDT_HAL_NOINIT; //~WDT_stalledTasks if the record is valid, rather than power-up garbage
+
 //-------------------------------------------------------------------------------------------------------------------
 //Watchdog Timer ISR (Interrupt Service Routine)
 //-gets called automatically every time the Watchdog Timer expires
@@ -87,62 +110,148 @@ eRCaGuy_WDTimer wdt;
 ISR(WDT_vect)
 {
   //prevent Watchdog Timer from resetting the microcontroller
-  wdt_disable(); //disable the Watchdog timer (ie: set the WDE bit to 0) in order to prevent the mcu from entering System Reset Mode 
-                 //right after this ISR exits; see here for more info: http://www.nongnu.org/avr-libc/user-manual/group__avr__watchdog.html
-								 //Also see datasheet Table 11-1 pg. 55
-  wdt_reset(); //reset elapsed Watchdog timer to zero
-  
-  //determine if the delay is over yet, or if we need to delay some more
-  long t_elapsed = millis() - wdt._t_WDT_start; //ms
-  wdt._t_WDT_delay_remaining = wdt._t_WDT_delay_desired - t_elapsed; //ms; update this value by subtracting off the elapsed time
-  
-	wdt.update_WDT_period(); //use the _t_WDT_delay_remaining value to determine the new _WDT_period value
-  if (wdt._WDT_period!=_DESIRED_DELAY_TOO_SHORT)
-    wdt.WDT_begin(); //start the new WDT delay time
-  else //delay is over, time to call the userFunc() function!
-  {
-		WDTCSR &= ~_BV(WDIE); //clear the WatchDog Interrupt Enable (WDIE) bit to 0, in order to disable the WDT_vect interrupt!
-		wdt._t_WDT_end = millis(); //ms; grab the end time
-    wdt._userInterruptCalled = true;
-		wdt._t_WDT_delay_actual = wdt._t_WDT_end - wdt._t_WDT_start; //ms; actual time elapsed
-    
-		//prepare to delay again *only* if we are on REPEAT mode
-		if (wdt._WDT_mode==_WDT_REPEAT)
-		{
-			//prepare to do it again!
-			long t_excess = wdt._t_WDT_delay_actual - wdt._t_WDT_delay_desired; //ms; determine excess time we delayed, but shouldn't have
-			wdt._t_WDT_start = wdt._t_WDT_end - t_excess; //update; subtract the excess time from the start time so that we only wait the *exact* period we desired to wait;
-																										//this basically acts like a real-time error correction to ensure consistent & very precise
-																										//timing over long periods (many delay iterations), despite jitter over short periods (each delay iteration).
-			
-			//find the new time remaining to wait
-			t_elapsed = millis() - wdt._t_WDT_start; //ms
-			wdt._t_WDT_delay_remaining = wdt._t_WDT_delay_desired - t_elapsed; //ms; update this value by subtracting off the elapsed time
-			
-			wdt.update_WDT_period(); //use the new _t_WDT_delay_remaining value to determine the new _WDT_period value
-			if (wdt._WDT_period!=_DESIRED_DELAY_TOO_SHORT)
-				wdt.WDT_begin(); //start the new WDT delay time
-		}
-		wdt.userFunc(); //do some user-defined, attached function
-  }
+  //-except in supervision mode: the hardware has just cleared WDIE, so the WDT is now in System Reset Mode, & stays 
+  // armed that way until WDT_begin() turns the interrupt back on; see beginSupervision()
+  if (wdt._supervisorTimer==_WDT_NO_TIMER)
+    WDT_HAL_disable(); //disable the Watchdog timer (ie: set the WDE bit to 0) in order to prevent the mcu from entering System Reset Mode 
+                       //right after this ISR exits; see here for more info: http://www.nongnu.org/avr-libc/user-manual/group__avr__watchdog.html
+								       //Also see datasheet Table 11-1 pg. 55
+  
+  if (wdt._chain!=NULL)
+    wdt.stepChain(); //a WDTimer<PeriodMs> is running; just start its next, precomputed, delay
+  else if (wdt._calibrating)
+    wdt.calibrationTick(); //calibrate() is measuring the WDT delays
+  else
+    wdt.processTimers(); //call every timer whose delay is over, then start the WDT delay for the next earliest deadline
+  wdt._stateGeneration++; //tell snapshot() to copy again, if it was interrupted
+}
+
+#if WDT_FINE
+//-------------------------------------------------------------------------------------------------------------------
+//Timer2 compare match ISR
+//-the end of a fine mode finish (see planFineFinish()); it's just like the end of a WDT delay segment
+//-------------------------------------------------------------------------------------------------------------------
+ISR(TIMER2_COMPA_vect)
+{
+  WDT_HAL_fineStop(); //it's a one-shot
+  wdt.processTimers();
+  wdt._stateGeneration++; //tell snapshot() to copy again, if it was interrupted
+}
+#endif
+
+#if WDT_SAMPLER
+//-------------------------------------------------------------------------------------------------------------------
+//ADC conversion complete ISR
+//-the end of one sample of the sampler (see beginSampler())
+//-------------------------------------------------------------------------------------------------------------------
+ISR(ADC_vect)
+{
+  wdt.sampleDone();
 }
+#endif
 
 //-------------------------------------------------------------------------------------------------------------------
 //class constructor method
 //-------------------------------------------------------------------------------------------------------------------
 eRCaGuy_WDTimer::eRCaGuy_WDTimer()
 {
+  for (byte i=0; i<WDT_MAX_TIMERS; i++)
+  {
+    _timers[i].func = NULL; //mark the slot as free
+    _timers[i].heapIndex = _WDT_NO_TIMER; //not scheduled
+    _timers[i].overrunPolicy = _WDT_OVERRUN_CATCH_UP;
+    _timers[i].maxCatchUp = 255;
+  }
+  _heapSize = 0;
+  _stateGeneration = 0;
+  
+  _sleepMode = SLEEP_MODE_PWR_DOWN;
+  _sleepOptions = 0;
+  _beforeSleep = NULL;
+  _afterWake = NULL;
+  _numUserFuncCalls = 0;
+  _sleptThisSegment = false;
+  _t_anchor = 0;
+  _t_anchor_millis = 0;
+  _t_millis_missed = 0;
+  _t_now = 0;
+  _t_now_frac = 0;
+  _t_now_hi = 0;
+  _t_offset = 0;
+  _segmentRunning = false;
+  _heldOff = false;
+  for (byte i=0; i<10; i++)
+  {
+    _t_segment_q8[i] = (16UL << i) << 8; //nominal WDT delay lengths
+    _t_segment_frac[i] = 0;
+  }
+#if WDT_FINE
+  _t_fine_us = 0;
+  _t_fine_q16 = 0;
+#endif
+
+  _t_asleep = 0;
+  _t_duty_start = 0;
+  
+  _chain = NULL;
+  _chainFunc = NULL;
+  
+#if WDT_STATS
+  _statsTimer = _WDT_LEGACY_TIMER;
+  resetStats();
+#endif
+  
+  _deferred = false;
+  _eventHead = 0;
+  _eventTail = 0;
+  _eventOverflows = 0;
+  
+  _calibrating = false;
+  _calReference = NULL;
+  _calPeriod = WDTO_16MS;
+  _calTicks = 0;
+  _calMode = _WDT_CAL_AUTO;
+  for (byte i=0; i<10; i++)
+    _calSamples[i] = 0;
+  _calCountdown = WDT_CAL_SAMPLE_EVERY;
+  _bgCalSegment = false;
+  _bgCalReference = WDT_HAL_micros;
+  _t_segment_start_us = 0;
+  
+  _supervisorTimer = _WDT_NO_TIMER;
+  _supervisedTasks = 0;
+  for (byte i=0; i<WDT_MAX_TASKS; i++)
+    _heartbeats[i] = 0;
+  
+#if WDT_SAMPLER
+  _samplerTimer = _WDT_NO_TIMER;
+  _sampleBuffer = NULL;
+  _batchSize = 0;
+  _sampleChannel = 0;
+  _sampleIndex = 0;
+  _sampleHalf = 0;
+  _sampleState = _WDT_SAMPLE_IDLE;
+  _batchReady = false;
+  _inSleep = false;
+  _batchHandler = NULL;
+  _t_batch_start = 0;
+  _batchOverruns = 0;
+  _ADCSRA_user = 0;
+#endif
 }
 
 //-------------------------------------------------------------------------------------------------------------------
 //attachInterrupt
 //-use the Watchdog Timer to do some action every ___ ms
-//-returns whether or not the delay time is valid; ie: any delay time <8ms is too short
+//-returns whether or not the delay time is valid; ie: any delay time <8ms is too short (<1ms in fine mode, WDT_FINE 1)
+//-also returns false while a WDTimer<PeriodMs> or calibrate() owns the WDT; the message printed says which it was
 //-the mode can be _WDT_DO_ONCE, or _WDT_REPEAT
 //--_WDT_DO_ONCE will interrupt your code & execute the interrupt function one time after the specified time
 //--_WDT_REPEAT will repeatedly call the interrupt function at the specified time interval
+//-t_slack_ms (optional): how early or late (in ms) each call may be, in order to save WDT wakeups; less than half of the
+// delay time, or it is cut down to that; see planWake()
 //-------------------------------------------------------------------------------------------------------------------
-boolean eRCaGuy_WDTimer::attachInterrupt(void (*isr)(),long t_desired_delay_ms,boolean mode)
+boolean eRCaGuy_WDTimer::attachInterrupt(void (*isr)(),int32_t t_desired_delay_ms,boolean mode,unsigned int t_slack_ms)
 {  
   //local variables
   boolean valid_desired_delay_time;
@@ -150,58 +259,64 @@ boolean eRCaGuy_WDTimer::attachInterrupt(void (*isr)(),long t_desired_delay_ms,b
 	userFunc = isr; //attach the user's function to the interrupt
 	_WDT_mode = mode;
 
-	valid_desired_delay_time = timedInterrupt(t_desired_delay_ms,mode);
+	valid_desired_delay_time = timedInterrupt(t_desired_delay_ms,mode,t_slack_ms);
 	return valid_desired_delay_time;
 }
 
 //-------------------------------------------------------------------------------------------------------------------
 //timedInterrupt()
 //-use the Watchdog Timer to do some action every ___ ms
-//-returns whether or not the delay time is valid; ie: any delay time <8ms is too short
+//-returns whether or not the delay time is valid; ie: any delay time <8ms is too short (<1ms in fine mode, WDT_FINE 1)
+//-also returns false while a WDTimer<PeriodMs> or calibrate() owns the WDT; the message printed says which it was
 //-the mode can be _WDT_DO_ONCE, or _WDT_REPEAT
 //--_WDT_DO_ONCE will interrupt your code & execute the interrupt function one time after the specified time
 //--_WDT_REPEAT will repeatedly call the interrupt function at the specified time interval
+//-t_slack_ms (optional): how early or late (in ms) each call may be, in order to save WDT wakeups; less than half of the
+// delay time, or it is cut down to that; see planWake()
+//-this only (re)starts the attachInterrupt() timer (ID 0); any timers started with addTimer() keep running
 //-------------------------------------------------------------------------------------------------------------------
-boolean eRCaGuy_WDTimer::timedInterrupt(long t_desired_delay_ms,boolean mode)
+boolean eRCaGuy_WDTimer::timedInterrupt(int32_t t_desired_delay_ms,boolean mode,unsigned int t_slack_ms)
 {
 	_WDT_mode = mode;
 	
 	//local variables
   boolean valid_desired_delay_time;
+  boolean WDT_busy; //a WDTimer<PeriodMs> or calibrate() owns the WDT
 	
-	//first, disable the WDT just in case its in the middle of an operation right now
+	//first, stop this timer just in case its in the middle of an operation right now
 	detachInterrupt();
 	
 	uint8_t SREG_old = SREG; //back up the AVR Status Register; see example in datasheet on pg. 14, as well as Nick Gammon's "Interrupts" article - http://www.gammon.com.au/forum/?id=11488
   noInterrupts(); //prepare for critical section of code (ex: writing to a volatile variable)
-  _t_WDT_start = millis(); //initialize
-  _t_WDT_delay_desired = t_desired_delay_ms; //initialize
-  _t_WDT_delay_remaining = t_desired_delay_ms; //initialize
-  SREG = SREG_old; //restore previous interrupt status
-  
-	//update the global volatile variable byte "_WDT_period"
-	update_WDT_period();
-	if (_WDT_period!=_DESIRED_DELAY_TOO_SHORT)
-  {
-    WDT_begin(); //start the initial WDT delay time
-    valid_desired_delay_time = true;
-  }
-  else
+  WDT_busy = (_chain!=NULL || _calibrating);
+  valid_desired_delay_time = startTimer(_WDT_LEGACY_TIMER,userFunc,t_desired_delay_ms,mode,t_slack_ms);
+  if (valid_desired_delay_time)
   {
-		Serial.println(F("desired delay too short"));
-    valid_desired_delay_time = false;
+    _t_WDT_start = _timers[_WDT_LEGACY_TIMER].t_start; //initialize
+    _t_WDT_delay_desired = t_desired_delay_ms; //initialize
   }
+  SREG = SREG_old; //restore previous interrupt status
+  
+	if (!valid_desired_delay_time)
+	{
+		if (WDT_busy)
+			Serial.println(F("WDT in use by a WDTimer<> or calibrate()"));
+		else
+			Serial.println(F("desired delay too short"));
+	}
   return valid_desired_delay_time;
 } //end of timedInterrupt() function
 	
 //-------------------------------------------------------------------------------------------------------------------
 //detachInterrupt()
+//-stops the attachInterrupt() timer (ID 0); the Watchdog Timer itself is turned off once no timers are left running
 //-------------------------------------------------------------------------------------------------------------------
 void eRCaGuy_WDTimer::detachInterrupt()
 {
-	wdt_disable();
-	wdt_reset();
-	WDTCSR &= ~_BV(WDIE); //clear the WatchDog Interrupt Enable (WDIE) bit to 0
+	uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+	unscheduleTimer(_WDT_LEGACY_TIMER);
+	SREG = SREG_old; //restore previous interrupt status
 }
 
 //-------------------------------------------------------------------------------------------------------------------
@@ -214,62 +329,1922 @@ void eRCaGuy_WDTimer::stop()
 }
 
 //-------------------------------------------------------------------------------------------------------------------
-//WDT_begin()
-//-INPUT: requires the public member (acts like a global variable within the class) _WDT_period to already by updated
-//-OUTPUT: none; but prepares the WDT interrupt to go off
+//addTimer()
+//-start an additional timer which runs independently of the attachInterrupt() timer, and of all other timers
+//-the delay time, mode & slack are the same as for attachInterrupt()
+//-returns the timer's ID (1 to WDT_MAX_TIMERS-1), to be passed to cancelTimer(), or _WDT_NO_TIMER if the delay
+// time is too short (<8ms, or <1ms in fine mode) or all WDT_MAX_TIMERS timer slots are in use
+//-a _WDT_DO_ONCE timer frees its slot (and its ID) right before its function is called
 //-------------------------------------------------------------------------------------------------------------------
-void eRCaGuy_WDTimer::WDT_begin()
+byte eRCaGuy_WDTimer::addTimer(void (*func)(),int32_t t_desired_delay_ms,boolean mode,unsigned int t_slack_ms)
 {
-  //set up the Watchdog Timer (WDT)
-  wdt_enable(_WDT_period); //enable the WD Timer (set WDE bit to 1 [Table 11-1 pg. 55 --> System Reset Mode]) & set the specified timeout period
-  wdt_reset(); //reset the timer to zero and let it start counting
-  WDTCSR |= _BV(WDIE); //set the WatchDog Interrupt Enable (WDIE) bit to 1, in order to ENABLE the WDT_vect interrupt!
+  byte timerID = _WDT_NO_TIMER;
+  if (func==NULL)
+    return _WDT_NO_TIMER;
+  
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  byte i = freeTimerSlot();
+  if (i!=_WDT_NO_TIMER && startTimer(i,func,t_desired_delay_ms,mode,t_slack_ms))
+    timerID = i;
+  SREG = SREG_old; //restore previous interrupt status
+  return timerID;
 }
 
 //-------------------------------------------------------------------------------------------------------------------
-//update_WDT_period()
-//-use the _t_WDT_delay_remaining value to determine the new _WDT_period value
-//-INPUT: requires the public member (acts like a global variable within the class) _t_WDT_delay_remaining to already by updated
-//-OUTPUT: updates the public member _WDT_period
+//atTime()
+//-like addTimer(), but calls func once, at the absolute time t_ms, in now64() time (see setNow()), rather than after a delay
+//-if t_ms has already gone by, func is called as soon as possible
+//-returns _WDT_NO_TIMER if all of the timer slots are in use, or if t_ms is more than 2^31-1 ms (24.8 days) away; for 
+// times further away than that, use atTime() to call a function which then calls atTime() again
 //-------------------------------------------------------------------------------------------------------------------
-void eRCaGuy_WDTimer::update_WDT_period()
+byte eRCaGuy_WDTimer::atTime(void (*func)(),uint64_t t_ms,unsigned int t_slack_ms)
 {
-  //copy out a volatile variable
-  uint8_t SREG_old = SREG; //back up the AVR Status Register; see example in datasheet on pg. 14, as well as Nick Gammon's "Interrupts" article - http://www.gammon.com.au/forum/?id=11488
-  noInterrupts(); //prepare for critical section of code (ex: writing to a volatile variable)
-  long _t_WDT_delay_remaining_cpy = _t_WDT_delay_remaining; //copy value
-  SREG = SREG_old; //restore previous interrupt status
-  
-  if (_t_WDT_delay_remaining_cpy >= 8192)
-    _WDT_period = WDTO_8192MS;
-  else if (_t_WDT_delay_remaining_cpy >= 4096)
-    _WDT_period = WDTO_4096MS;
-  else if (_t_WDT_delay_remaining_cpy >= 2048)
-    _WDT_period = WDTO_2048MS;
-  else if (_t_WDT_delay_remaining_cpy >= 1024)
-    _WDT_period = WDTO_1024MS;
-  else if (_t_WDT_delay_remaining_cpy >= 512)
-    _WDT_period = WDTO_512MS;
-  else if (_t_WDT_delay_remaining_cpy >= 256)
-    _WDT_period = WDTO_256MS;
-  else if (_t_WDT_delay_remaining_cpy >= 128)
-    _WDT_period = WDTO_128MS;
-  else if (_t_WDT_delay_remaining_cpy >= 64)
-    _WDT_period = WDTO_64MS;
-  else if (_t_WDT_delay_remaining_cpy >= 32)
-    _WDT_period = WDTO_32MS;
-  else if (_t_WDT_delay_remaining_cpy >= 16/2) //If the desired delay is 8ms, then I will delay 16, and I will have delayed *8 too many*.  
-																							 //If the desired delay is 9ms, then I will delay 16, which is *7 too many*. If the desired delay is 7ms, 
-																							 //then I will not delay at all, which is *7ms too few.*
-                                               //So, with this statement as-is, the precision is only +8ms/-7ms. 
-                                               //Ie: For any given desired_delay in ms, you will delay somewhere between 8ms too many, and 7ms too few.
-    _WDT_period = WDTO_16MS;
-  else //don't delay at all
-    _WDT_period = _DESIRED_DELAY_TOO_SHORT; //set to indicate the delay is too short
-} //end of update_WDT_period()
+  byte timerID = _WDT_NO_TIMER;
+  if (func==NULL)
+    return _WDT_NO_TIMER;
+  
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint64_t t_now64 = timeNow64() + _t_offset; //ms
+  int32_t t_delay = 0; //ms
+  if (t_ms > t_now64)
+    t_delay = (t_ms - t_now64 > 0x7FFFFFFFUL) ? -1 : (int32_t)(t_ms - t_now64);
+  byte i = freeTimerSlot();
+  if (i!=_WDT_NO_TIMER && t_delay >= 0)
+  {
+    uint32_t t_now = timeNow(); //ms
+    if (startTimerAt(i,func,t_now,t_now + t_delay,t_delay,_WDT_DO_ONCE,t_slack_ms))
+      timerID = i;
+  }
+  SREG = SREG_old; //restore previous interrupt status
+  return timerID;
+}
+
+//true if the WDT can do a delay (or period) this long
+static boolean validDelay(int32_t t_ms)
+{
+#if WDT_FINE
+  return (t_ms >= 1); //Timer2 finishes off the part that the WDT can't do; see planFineFinish()
+#else
+  return (t_ms >= 16/2); //any delay <8ms rounds down to no delay at all; see update_WDT_period()
+#endif
+}
+
+//(hi*2^32 + lo) % divisor, for any divisor from 1 to 2^31, with 32-bit math only; long division, 1 bit at a time
+static uint32_t mod64(uint32_t hi,uint32_t lo,uint32_t divisor)
+{
+  uint32_t remainder = hi % divisor;
+  for (byte i=0; i<32; i++)
+  {
+    remainder = (remainder << 1) | ((lo >> 31) & 1); //< 2*divisor, so it can't overflow
+    lo <<= 1;
+    if (remainder >= divisor)
+      remainder -= divisor;
+  }
+  return remainder;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//everyAligned()
+//-like addTimer() with _WDT_REPEAT, but each call is on a period_ms boundary of the now64() time, plus phase_ms; ex: 
+// everyAligned(func,10000,2000) calls func at now64() = 2000, 12000, 22000, etc, no matter when it was started
+//-the first call is at the next one of those times which is still ahead; every period is then timed from the last 
+// deadline, like every _WDT_REPEAT timer, so the phase never drifts w.r.t. now64(); nodes which share the same time 
+// (see setNow()), & are calibrated (see calibrate()), stay lined up with each other
+//-its overrun policy is _WDT_OVERRUN_SKIP, so it stays on its boundaries if it falls behind; see setOverrunPolicy()
+//-phase_ms must be from 0 to period_ms-1; returns _WDT_NO_TIMER if it isn't, or if the period is too short (<8ms, or <1ms in fine
+// mode), or if all of the timer slots are in use
+//-------------------------------------------------------------------------------------------------------------------
+byte eRCaGuy_WDTimer::everyAligned(void (*func)(),int32_t period_ms,int32_t phase_ms,unsigned int t_slack_ms)
+{
+  byte timerID = _WDT_NO_TIMER;
+  if (func==NULL || phase_ms<0 || phase_ms>=period_ms)
+    return _WDT_NO_TIMER;
+  
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint64_t t_now64 = timeNow64() + _t_offset + (period_ms - phase_ms); //ms; + (period - phase), so it can't go negative
+  int32_t t_first = period_ms - (int32_t)mod64((uint32_t)(t_now64 >> 32),(uint32_t)t_now64,period_ms); //ms; 1 to period_ms
+  byte i = freeTimerSlot();
+  if (i!=_WDT_NO_TIMER && validDelay(period_ms))
+  {
+    uint32_t t_now = timeNow(); //ms
+    _timers[i].overrunPolicy = _WDT_OVERRUN_SKIP;
+    if (startTimerAt(i,func,t_now + t_first - period_ms,t_now + t_first,period_ms,_WDT_REPEAT,t_slack_ms))
+      timerID = i;
+  }
+  SREG = SREG_old; //restore previous interrupt status
+  return timerID;
+}
+
+//returns the ID of a free addTimer() slot, set to the default overrun policy, or _WDT_NO_TIMER if there are none; interrupts must be off
+byte eRCaGuy_WDTimer::freeTimerSlot()
+{
+  for (byte i=_WDT_LEGACY_TIMER+1; i<WDT_MAX_TIMERS; i++)
+  {
+    if (_timers[i].func==NULL) //free slot
+    {
+      _timers[i].overrunPolicy = _WDT_OVERRUN_CATCH_UP; //the defaults; see setOverrunPolicy()
+      _timers[i].maxCatchUp = 255;
+      return i;
+    }
+  }
+  return _WDT_NO_TIMER;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//cancelTimer()
+//-stop a timer started with addTimer() and free its slot
+//-returns true if the timer was running
+//-------------------------------------------------------------------------------------------------------------------
+boolean eRCaGuy_WDTimer::cancelTimer(byte timerID)
+{
+  boolean was_running;
+  if (timerID>=WDT_MAX_TIMERS)
+    return false;
+  
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  was_running = (_timers[timerID].heapIndex!=_WDT_NO_TIMER);
+  if (timerID==_supervisorTimer)
+    _supervisorTimer = _WDT_NO_TIMER; //that's the end of supervision mode, too
+#if WDT_SAMPLER
+  if (timerID==_samplerTimer)
+    stopSampling(); //& of the sampler
+#endif
+  unscheduleTimer(timerID);
+  _timers[timerID].func = NULL; //free the slot
+  SREG = SREG_old; //restore previous interrupt status
+  return was_running;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//processTimers()
+//-called by the WDT ISR every time a WDT delay segment expires
+//-pops every timer whose deadline has been reached off of the heap, puts the _WDT_REPEAT ones back on with their next
+// deadline, starts the WDT delay for the new earliest deadline, and only THEN calls the user functions, so that the
+// time they take to run doesn't delay the next period
+//-each timer costs O(log(WDT_MAX_TIMERS)) to pop & push, so the ISR time stays bounded as the # of timers grows
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::processTimers()
+{
+  //local variables
+  void (*funcsDue[WDT_MAX_TIMERS])(); //user functions to call
+  byte repeatIDs[WDT_MAX_TIMERS]; //timers to put back onto the heap
+  byte funcIDs[WDT_MAX_TIMERS]; //their timer IDs
+  byte numDue = 0;
+  byte numFuncs = 0;
+  byte numRepeat = 0;
+  
+  segmentDone(); //add the WDT delay which just ended to the time base
+  uint32_t t_now = _t_now; //ms
+  boolean heldOff = _heldOff; //the segment which just ended was held up by the user functions; see below
+  _heldOff = false; //it only applies to the deadlines reached at the end of that segment, ie: in this ISR
+#if WDT_STATS
+  _statsWakeups++;
+  boolean statsHeldOff = _statsHeldOff; //see callUserFunc()
+  _statsHeldOff = false; //it only applies to the deadlines reached by the segment which was held off, ie: in this ISR
+#endif
+  
+  while (_heapSize>0)
+  {
+    byte timerID = _heap[0];
+    WDT_timer_t* timer = &_timers[timerID];
+    
+    //determine if the delay is over yet, or if we need to delay some more
+    _t_WDT_delay_remaining = (int32_t)(timer->t_wake - t_now); //ms
+    update_WDT_period(); //use the _t_WDT_delay_remaining value to determine the new _WDT_period value
+    if (_WDT_period!=_DESIRED_DELAY_TOO_SHORT)
+      break; //the earliest deadline hasn't been reached yet, so none of the others have either
+#if WDT_FINE
+    if (planFineFinish(timer->t_wake,t_now,false))
+      break; //not quite reached yet either; finish the delay with Timer2
+#endif
+    
+    //delay is over, time to call this timer's function!
+    heapRemove(0);
+    numDue++;
+    if (timerID==_supervisorTimer)
+      superviseWindow(); //not a user function; always done right here, even in deferred mode
+#if WDT_SAMPLER
+    else if (timerID==_samplerTimer)
+      startSample(); //not a user function either; the batch handler is only called once a batch is full (see sampleDone())
+#endif
+    else
+    {
+#if WDT_STATS
+      statsPeriod(timerID,(int32_t)(t_now - timer->t_start),timer->t_delay_desired,statsHeldOff);
+#endif
+      if (_deferred)
+        pushEvent(timerID,timer->func,t_now,(int32_t)(t_now - timer->t_start)); //loop() will call it; see dispatch()
+      else
+      {
+        funcIDs[numFuncs] = timerID;
+        funcsDue[numFuncs++] = timer->func;
+      }
+      _userInterruptCalled = true;
+      _numUserFuncCalls++;
+      if (timerID==_WDT_LEGACY_TIMER)
+      {
+        _t_WDT_end = t_now; //ms; grab the end time
+        _t_WDT_delay_actual = _t_WDT_end - _t_WDT_start; //ms; actual time elapsed
+      }
+    }
+    
+    //prepare to delay again *only* if we are on REPEAT mode
+    if (timer->mode==_WDT_REPEAT)
+    {
+      //start the next period exactly at the end of the desired period, rather than at t_now, so that we only wait the *exact* period
+      //we desired to wait; this basically acts like a real-time error correction to ensure consistent & very precise
+      //timing over long periods (many delay iterations), despite jitter over short periods (each delay iteration).
+      timer->t_start = timer->t_deadline;
+      timer->t_deadline += timer->t_delay_desired;
+      handleOverrun(timer,t_now,heldOff); //in case the next period is already over too
+      planWake(timer,t_now);
+      repeatIDs[numRepeat++] = timerID;
+      if (timerID==_WDT_LEGACY_TIMER)
+        _t_WDT_start = timer->t_start;
+    }
+    else if (timerID!=_WDT_LEGACY_TIMER)
+      timer->func = NULL; //free the slot
+  }
+  
+  //prepare to do it again!
+  for (byte i=0; i<numRepeat; i++)
+    heapInsert(repeatIDs[i]);
+  if (numDue>0)
+    scheduleNextSegment(t_now);
+  else if (_heapSize>0)
+    WDT_begin(); //the _WDT_period (or fine finish) for the earliest deadline was already found above; start the new WDT delay time
+  else
+    startIdle(); //no timers left
+  
+  //do the user-defined, attached functions (none in deferred mode)
+  for (byte i=0; i<numFuncs; i++)
+    callUserFunc(funcIDs[i],funcsDue[i]);
+  
+  //the WDT delay segment started above kept counting while they ran; if it has already ended, they held this ISR up 
+  //past it, & its interrupt is pending, so the ISR runs again as soon as this one returns; the time base gets that 
+  //segment, but not the time they ran on past its end, so the next deadline is reached late, by an unknown amount; 
+  //the WDT's own pending interrupt is the only way to see this, since Timer0 (millis() & micros()) can't count more 
+  //than ~1ms with interrupts off either
+  //-only the deadlines at the end of that segment are known to have gone by while they ran; if it was an earlier 
+  // segment of the period (ex: a 600ms function, on a 1000ms timer whose periods start with a 512ms delay), they may 
+  // or may not have, so the next ISR, which reaches no deadline, just drops the flag; ie: missed periods can be 
+  // under-counted this way, but a function shorter than its period never counts as one
+  if (numFuncs>0 && segmentOverdue())
+    _heldOff = true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//startTimer()
+//-(re)starts the timer in slot timerID; must be called with interrupts off
+//-returns false if the delay time is too short (<8ms, or <1ms in fine mode), or a WDTimer<PeriodMs> or calibrate() owns the WDT, in which case the timer is not started
+//-------------------------------------------------------------------------------------------------------------------
+boolean eRCaGuy_WDTimer::startTimer(byte timerID,void (*func)(),int32_t t_desired_delay_ms,boolean mode,unsigned int t_slack_ms)
+{
+  if (!validDelay(t_desired_delay_ms))
+    return false;
+  uint32_t t_now = timeNow(); //ms
+  return startTimerAt(timerID,func,t_now,t_now + t_desired_delay_ms,t_desired_delay_ms,mode,t_slack_ms);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//startTimerAt()
+//-same as startTimer(), but with the first period given in the time base (t_start to t_deadline), rather than starting 
+// now; t_period_ms is the length of the periods after it (_WDT_REPEAT)
+//-must be called with interrupts off
+//-------------------------------------------------------------------------------------------------------------------
+boolean eRCaGuy_WDTimer::startTimerAt(byte timerID,void (*func)(),uint32_t t_start,uint32_t t_deadline,int32_t t_period_ms,boolean mode,unsigned int t_slack_ms)
+{
+  if (_chain!=NULL || _calibrating)
+    return false;
+  
+  unscheduleTimer(timerID); //in case it's already running
+  uint32_t t_now = timeNow(); //ms
+  WDT_timer_t* timer = &_timers[timerID];
+  timer->func = func;
+  timer->t_start = t_start;
+  timer->t_deadline = t_deadline;
+  timer->t_delay_desired = t_period_ms;
+  if ((int32_t)t_slack_ms > (t_period_ms - 1)/2)
+    t_slack_ms = (t_period_ms - 1)/2; //see planWake()
+  timer->t_slack = t_slack_ms;
+  timer->mode = mode;
+  timer->behind = 0;
+  timer->missed = 0;
+  timer->coalesced = 0;
+  planWake(timer,t_now);
+  heapInsert(timerID);
+  
+  //if this is now the earliest deadline, the WDT delay currently running (if any) may be too long, so restart it
+  if (_heap[0]==timerID)
+  {
+    stopSegment();
+    scheduleNextSegment(t_now);
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//handleOverrun()
+//-called by the ISR for a _WDT_REPEAT timer, right after its deadline has been moved on to the end of its next period
+//-if that deadline has already passed too (ex: the period is shorter than the shortest WDT delay), the timer has fallen
+// behind; what happens then depends on its overrun policy (see setOverrunPolicy())
+//-every deadline which had already passed when the timer was called counts as missed (once); every one that is then
+// skipped, rather than called late, also counts as coalesced
+//-heldOff: the user functions called by the ISR ran past the end of the WDT delay segment which reached this deadline 
+// (see processTimers()), so this call is late by an unknown amount, since the WDT only counts whole segments; it 
+// counts as missed too, & a _WDT_OVERRUN_REANCHOR timer restarts its period from now
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::handleOverrun(WDT_timer_t* timer,uint32_t t_now,boolean heldOff)
+{
+  int32_t t_since_start = (int32_t)(t_now - timer->t_start); //ms; t_now - t_deadline itself would overflow, for a period near 2^31 ms which was called a bit early
+  byte behind_prev = timer->behind;
+  if (heldOff)
+    timer->missed++;
+  if (t_since_start < timer->t_delay_desired)
+  {
+    if (heldOff && timer->overrunPolicy==_WDT_OVERRUN_REANCHOR)
+    {
+      timer->t_start = t_now;
+      timer->t_deadline = t_now + timer->t_delay_desired;
+    }
+    timer->behind = 0; //on time
+    return;
+  }
+  
+  uint32_t t_late = (uint32_t)(t_since_start - timer->t_delay_desired); //ms
+  uint32_t behind = t_late/(uint32_t)timer->t_delay_desired + 1; //# of deadlines which have passed
+  uint32_t counted = (behind_prev > 0) ? behind_prev - 1 : 0; //# of them already counted at the last call (which just took care of one of them)
+  if (behind > counted)
+    timer->missed += behind - counted;
+  
+  uint32_t skipped = 0;
+  if (timer->overrunPolicy==_WDT_OVERRUN_REANCHOR)
+  {
+    timer->coalesced += behind;
+    timer->t_start = t_now;
+    timer->t_deadline = t_now + timer->t_delay_desired;
+    timer->behind = 0;
+    return;
+  }
+  else if (timer->overrunPolicy==_WDT_OVERRUN_SKIP)
+    skipped = behind;
+  else if (behind > timer->maxCatchUp) //_WDT_OVERRUN_CATCH_UP
+    skipped = behind - timer->maxCatchUp;
+  timer->coalesced += skipped;
+  timer->t_deadline += skipped*timer->t_delay_desired;
+  timer->t_start = timer->t_deadline - timer->t_delay_desired;
+  behind -= skipped;
+  timer->behind = (behind > 255) ? 255 : (byte)behind;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//setOverrunPolicy()
+//-what a _WDT_REPEAT timer (ID timerID) does when it falls behind by one or more whole periods:
+//--_WDT_OVERRUN_CATCH_UP (the default): its user function is called once for each missed period, back to back (ie: at
+//  the end of the shortest WDT delay), but for at most maxCatchUp of them; the rest are skipped. The default maxCatchUp
+//  is 255; the one here (1) only catches up the most recent missed period.
+//--_WDT_OVERRUN_SKIP: the missed periods are skipped; the next call is at the next deadline which is still ahead, so 
+//  the calls stay phase-aligned with the original start time
+//--_WDT_OVERRUN_REANCHOR: the missed periods are skipped, & the next period starts now; ie: the phase is lost, but 
+//  the time between calls is never less than the period
+//-the policy stays with an attachInterrupt() timer (ID 0) through timedInterrupt() calls; addTimer() timers start 
+// with the default
+//-returns false if timerID or policy is invalid
+//-------------------------------------------------------------------------------------------------------------------
+boolean eRCaGuy_WDTimer::setOverrunPolicy(byte timerID,byte policy,byte maxCatchUp)
+{
+  if (timerID>=WDT_MAX_TIMERS || policy>_WDT_OVERRUN_REANCHOR)
+    return false;
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  _timers[timerID].overrunPolicy = policy;
+  _timers[timerID].maxCatchUp = maxCatchUp;
+  SREG = SREG_old; //restore previous interrupt status
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//missedPeriods() & coalescedPeriods()
+//-since the timer (ID timerID) was last started; see handleOverrun()
+//-------------------------------------------------------------------------------------------------------------------
+uint32_t eRCaGuy_WDTimer::missedPeriods(byte timerID)
+{
+  if (timerID>=WDT_MAX_TIMERS)
+    return 0;
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t missed = _timers[timerID].missed;
+  SREG = SREG_old; //restore previous interrupt status
+  return missed;
+}
+
+uint32_t eRCaGuy_WDTimer::coalescedPeriods(byte timerID)
+{
+  if (timerID>=WDT_MAX_TIMERS)
+    return 0;
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t coalesced = _timers[timerID].coalesced;
+  SREG = SREG_old; //restore previous interrupt status
+  return coalesced;
+}
 
+//-------------------------------------------------------------------------------------------------------------------
+//beginSupervision()
+//-supervision mode: uses the WDT as a watchdog again, while the timers keep working
+//-the WDT is left in Interrupt & System Reset Mode: the ISR no longer disables it, so once the hardware has cleared 
+// WDIE (when the ISR starts), the next time-out resets the mcu, unless WDT_begin() restarts it first, like it does at 
+// the end of every ISR.  So if the ISR can't run anymore (ex: the code hangs with interrupts off), the mcu is reset.
+//-every task in taskMask (bit n = task n, 0 to WDT_MAX_TASKS-1) must call checkIn(n) at least once in every t_window_ms
+// window, ex: once per pass through its part of loop(); at the end of each window, the ISR checks that all of them did.
+// If one or more did not, it records them for stalledTasks() & resets the mcu right away (see superviseWindow()).
+//-the window must be longer than the longest time between 2 check-ins, including any time spent in sleep()
+//-the end of each window is a _WDT_REPEAT timer, which takes one of the addTimer() slots
+//-NOTE: the WDT delay the ISR starts right before calling the user functions is armed this way too, & a WDT interrupt
+// which is still held off at the next time-out after it also resets the mcu (datasheet pg. 55); so in supervision 
+// mode, the user functions called from the ISR must return within that delay plus one more of the same length, which
+// can be as short as 16ms + 16ms; call any longer ones from loop() instead, with setDeferred()
+//-NOTE: after a WDT reset, the WDT is still on (at 16ms), so it must be turned off right away at startup; the Optiboot 
+// bootloader (Arduino Uno) does so, but some older bootloaders don't, & keep resetting the mcu
+//-returns false if taskMask is 0, or if the timer can't be started (no free slot, or a WDTimer<PeriodMs> is running);
+// if supervision mode is already on, it is restarted with the new settings
+//-------------------------------------------------------------------------------------------------------------------
 
+//the supervision window timer's function; the ISR calls superviseWindow() directly instead, so this is only a placeholder
+static void superviseTasks()
+{
+}
 
+boolean eRCaGuy_WDTimer::beginSupervision(byte taskMask,int32_t t_window_ms)
+{
+  if (taskMask==0)
+    return false;
+  stopSupervision();
   
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  WDT_stalledTasks = 0; //forget the last reset
+  WDT_stalledTasksCheck = 0xFF;
+  _supervisedTasks = taskMask;
+  for (byte i=0; i<WDT_MAX_TASKS; i++)
+    _heartbeats[i] = 0;
+  byte timerID = addTimer(superviseTasks,t_window_ms,_WDT_REPEAT);
+  if (timerID!=_WDT_NO_TIMER)
+  {
+    _timers[timerID].overrunPolicy = _WDT_OVERRUN_REANCHOR; //a late window must not be followed by an empty one
+    _supervisorTimer = timerID;
+    stopSegment(); //restart the segment which is running (if any), with the reset armed
+    scheduleNextSegment(timeNow());
+  }
+  SREG = SREG_old; //restore previous interrupt status
+  return (timerID!=_WDT_NO_TIMER);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//stopSupervision()
+//-back to using the WDT as a timer only; the other timers keep running
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::stopSupervision()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  byte timerID = _supervisorTimer;
+  if (timerID!=_WDT_NO_TIMER)
+  {
+    cancelTimer(timerID);
+    stopSegment(); //restart the segment which is running (if any), with the WDT back in Interrupt Mode only
+    scheduleNextSegment(timeNow());
+  }
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//stalledTasks()
+//-the task mask of the tasks which had not checked in when supervision mode last reset the mcu; call it in setup(), 
+// before beginSupervision(), which clears it
+//-0 if supervision mode hasn't reset the mcu (ex: after power-up, or a reset for any other reason)
+//-------------------------------------------------------------------------------------------------------------------
+byte eRCaGuy_WDTimer::stalledTasks()
+{
+  if ((byte)~WDT_stalledTasks!=WDT_stalledTasksCheck)
+    return 0; //no valid record
+  return WDT_stalledTasks;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//superviseWindow()
+//-called by the ISR at the end of each supervision window; checks that every supervised task has checked in, & 
+// clears their flags for the next window
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::superviseWindow()
+{
+  byte stalled = 0;
+  for (byte i=0; i<WDT_MAX_TASKS; i++)
+  {
+    if (!(_supervisedTasks & (1 << i)))
+      continue;
+    if (_heartbeats[i]==0)
+      stalled |= 1 << i;
+    _heartbeats[i] = 0;
+  }
+  if (stalled!=0)
+  {
+    WDT_stalledTasks = stalled;
+    WDT_stalledTasksCheck = ~stalled;
+    WDT_HAL_systemReset(); //never returns (except in the host simulator)
+  }
+}
+
+#if WDT_SAMPLER
+//-------------------------------------------------------------------------------------------------------------------
+//beginSampler()
+//-low-power periodic sampling: takes one ADC sample of channel (0-15, as in the ADMUX MUX bits; ex: 0 for A0) every
+// period_ms, & stores it in buffer, which must hold 2*batchSize samples: one half is filled while the other one (the
+// last full batch) is read.  Only once a half is full does the user code get woken up: batchHandler() is called (or
+// queued, in deferred mode), & sleep() returns; the batch is then read with readBatch().  So with sleep(), the mcu
+// sleeps in power-down between samples, wakes up for ~200us of SLEEP_MODE_ADC (ADC noise reduction, which also makes
+// for a quieter sample) per sample, & only runs your code once every batchSize samples.
+//-each batch must be read before the next one is full (batchSize*period_ms later); if not, it is overwritten, &
+// batchOverruns() counts it
+//-the ADC is only turned on for each sample, against AVcc, & turned back off after it; ADCSRA is put back the way it
+// was by stopSampler(); don't use analogRead() in between
+//-the sampling period is a _WDT_REPEAT timer, which takes one of the addTimer() slots, & which skips (rather than
+// catches up on) any periods it misses; see setOverrunPolicy()
+//-returns its timer ID, or _WDT_NO_TIMER if the sampler can't be started (no free slot, a WDTimer<PeriodMs> is running,
+// invalid period, or batchSize 0); if the sampler is already running, it is restarted with the new settings
+//-------------------------------------------------------------------------------------------------------------------
+
+//the sampling timer's function; the ISR calls startSample() directly instead, so this is only a placeholder
+static void takeSample()
+{
+}
+
+byte eRCaGuy_WDTimer::beginSampler(byte channel,int32_t period_ms,unsigned int* buffer,byte batchSize,void (*batchHandler)())
+{
+  if (buffer==NULL || batchSize==0)
+    return _WDT_NO_TIMER;
+  stopSampler();
+
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  byte timerID = addTimer(takeSample,period_ms,_WDT_REPEAT);
+  if (timerID!=_WDT_NO_TIMER)
+  {
+    _timers[timerID].overrunPolicy = _WDT_OVERRUN_SKIP; //a late sample is better than 2 back to back
+    _ADCSRA_user = WDT_HAL_adcOff();
+    _sampleBuffer = buffer;
+    _batchSize = batchSize;
+    _sampleChannel = channel;
+    _sampleIndex = 0;
+    _sampleHalf = 0;
+    _sampleState = _WDT_SAMPLE_IDLE;
+    _batchReady = false;
+    _batchHandler = batchHandler;
+    _t_batch_start = _t_now;
+    _batchOverruns = 0;
+    _samplerTimer = timerID;
+  }
+  SREG = SREG_old; //restore previous interrupt status
+  return timerID;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//stopSampler()
+//-stops the sampler (if running); the last full batch can still be read with readBatch()
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::stopSampler()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  if (_samplerTimer!=_WDT_NO_TIMER)
+    cancelTimer(_samplerTimer); //which calls stopSampling()
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//called with interrupts off, when the sampling timer is cancelled
+void eRCaGuy_WDTimer::stopSampling()
+{
+  _samplerTimer = _WDT_NO_TIMER;
+  WDT_HAL_adcSampleEnd(); //abort the conversion (if any)
+  _sampleState = _WDT_SAMPLE_IDLE;
+  WDT_HAL_adcRestore(_ADCSRA_user);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//readBatch()
+//-returns the batchSize samples of the batch which was filled last, oldest first, or NULL if there is no new batch since
+// the last call; it stays valid until the next batch is full
+//-------------------------------------------------------------------------------------------------------------------
+const unsigned int* eRCaGuy_WDTimer::readBatch()
+{
+  const unsigned int* batch = NULL;
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  if (_batchReady)
+  {
+    batch = &_sampleBuffer[(_sampleHalf ^ 1)*_batchSize]; //the half which isn't being filled
+    _batchReady = false;
+  }
+  SREG = SREG_old; //restore previous interrupt status
+  return batch;
+}
+
+uint32_t eRCaGuy_WDTimer::batchOverruns()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t overruns = _batchOverruns;
+  SREG = SREG_old; //restore previous interrupt status
+  return overruns;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//startSample()
+//-called by the WDT ISR at the start of every sampling period; turns the ADC on, & starts the conversion right away,
+// unless sleep() is running, in which case it's left for sleep() to start by going into SLEEP_MODE_ADC
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::startSample()
+{
+  if (_sampleState!=_WDT_SAMPLE_IDLE)
+    return; //the last one isn't done yet; can only happen if ADC_vect was held off for a whole period
+  WDT_HAL_adcSampleBegin(_sampleChannel);
+  if (_inSleep)
+    _sampleState = _WDT_SAMPLE_WAITING;
+  else
+  {
+    WDT_HAL_adcStartConversion();
+    _sampleState = _WDT_SAMPLE_CONVERTING;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//sampleDone()
+//-called by the ADC ISR at the end of every conversion; stores the sample, & once a half of the buffer is full, swaps
+// halves & wakes up the user code
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::sampleDone()
+{
+  unsigned int sample = WDT_HAL_adcSampleEnd();
+  if (_sampleState==_WDT_SAMPLE_IDLE)
+    return; //stopped in the meantime
+  _sampleState = _WDT_SAMPLE_IDLE;
+  _sampleBuffer[_sampleHalf*_batchSize + _sampleIndex] = sample;
+  if (++_sampleIndex < _batchSize)
+    return;
+
+  //batch full
+  if (_batchReady)
+    _batchOverruns++; //the last one was never read, & the half it's in is about to be refilled
+  _sampleIndex = 0;
+  _sampleHalf ^= 1;
+  _batchReady = true;
+  uint32_t t_now = _t_now; //ms
+  int32_t t_batch = (int32_t)(t_now - _t_batch_start); //ms
+  _t_batch_start = t_now;
+  _userInterruptCalled = true;
+  _numUserFuncCalls++; //sleep() returns
+  if (_batchHandler==NULL)
+    return;
+  if (_deferred)
+    pushEvent(_samplerTimer,_batchHandler,t_now,t_batch); //loop() will call it; see dispatch()
+  else
+    callUserFunc(_samplerTimer,_batchHandler);
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------
+//planWake()
+//-sets timer->t_wake, the time at which the timer will actually be called, for the period ending at timer->t_deadline
+//-with no slack, that's just t_deadline; otherwise, it's the end of the chain of WDT delays, starting at t_now, which
+// ends within [t_deadline - t_slack, t_deadline + t_slack] & takes the fewest wakeups (ties go to the one closest to
+// t_deadline); ex: 1000ms +/-30ms is 1 x 1024ms delay (1016ms with the WDT oscillator in the table at the top of 
+// eRCaGuy_WDTimer.h), rather than 512+256+128+64+32+16ms
+//-the next period is still timed from t_deadline, not from t_wake, so the errors don't add up; ie: the long term 
+// average period is exact, & each call is at most t_slack_ms early or late (plus the usual WDT jitter)
+//-the slack is always less than half of the period (see startTimerAt()), so that a late call can't end up at or past 
+// the next period's window; a call after the next deadline would count that period as missed (see handleOverrun())
+//-the WDT delays are counted in 16ms units (N = # of 16ms units; its set bits below 512 are one delay each, & the rest 
+// are 8192ms delays), & the fewest wakeups within [lo,hi] are found bit by bit, rather than by trying every N
+//-------------------------------------------------------------------------------------------------------------------
+
+//# of wakeups it takes to do units16 x 16ms
+static uint32_t numWakeups(uint32_t units16)
+{
+  uint32_t wakeups = units16 >> 9; //8192ms delays
+  for (unsigned int bits=units16 & 0x1FF; bits!=0; bits&=bits - 1)
+    wakeups++;
+  return wakeups;
+}
 
+//the # with the fewest set bits within [lo,hi], where lo <= hi < 512: keep the bits that lo & hi have in common, then the
+//smallest # with them set is either lo itself (if lo has nothing below them), or them plus the highest bit where lo & hi differ
+static unsigned int fewestBits(unsigned int lo,unsigned int hi)
+{
+  unsigned int diff = lo ^ hi;
+  if (diff==0)
+    return lo;
+  unsigned int bit = 0x100;
+  while (!(diff & bit))
+    bit >>= 1;
+  if ((lo & ((bit << 1) - 1))==0)
+    return lo;
+  return hi & ~(bit - 1);
+}
+
+void eRCaGuy_WDTimer::planWake(WDT_timer_t* timer,uint32_t t_now)
+{
+  timer->t_wake = timer->t_deadline;
+  if (timer->t_slack==0)
+    return;
+  
+  int32_t t_remaining = (int32_t)(timer->t_deadline - t_now); //ms
+  int32_t t_lo = t_remaining - (int32_t)timer->t_slack; //ms; the window
+  int32_t t_hi = t_remaining + (int32_t)timer->t_slack;
+  if (t_hi < (int32_t)(_t_segment_q8[WDTO_16MS] >> 8))
+    return; //not even one WDT delay fits
+  uint32_t lo = (t_lo > 0) ? toUnits16(t_lo,true) : 1; //16ms units
+  uint32_t hi = toUnits16(t_hi,false);
+  if (lo < 1)
+    lo = 1;
+  
+  //the units are based on the 16ms delay's calibrated length, but the longer delays may be a bit shorter or longer than 
+  //that; so if the chain found doesn't end within the window, move the window by the error & try again
+  for (byte i=0; i<4 && lo<=hi; i++)
+  {
+    //the fewest wakeups with the same # of 8192ms delays as lo, or with one more 8192ms delay & nothing else
+    uint32_t units = lo & ~0x1FFUL;
+    unsigned int bits_hi = ((hi >> 9)==(lo >> 9)) ? (hi & 0x1FF) : 0x1FF;
+    units |= fewestBits(lo & 0x1FF,bits_hi);
+    uint32_t units_next = (lo | 0x1FF) + 1;
+    if (units_next <= hi)
+    {
+      uint32_t wakeups = numWakeups(units);
+      uint32_t wakeups_next = numWakeups(units_next);
+      int32_t t_error = (int32_t)(units16ToMs(units) - (uint32_t)t_remaining); //ms
+      int32_t t_error_next = (int32_t)(units16ToMs(units_next) - (uint32_t)t_remaining);
+      if (wakeups_next < wakeups || (wakeups_next==wakeups && labs(t_error_next) < labs(t_error)))
+        units = units_next;
+    }
+    
+    int32_t t_chain = (int32_t)units16ToMs(units); //ms
+    if (t_chain < t_lo)
+      lo = units + toUnits16(t_lo - t_chain,true);
+    else if (t_chain > t_hi)
+    {
+      uint32_t t_excess = toUnits16(t_chain - t_hi,true); //16ms units
+      if (t_excess >= units)
+        break;
+      hi = units - t_excess;
+    }
+    else
+    {
+      timer->t_wake = t_now + t_chain;
+      return;
+    }
+  }
+  //no luck; just aim for t_deadline
+}
 
+//16ms units, in the calibrated length of the 16ms delay, rounded down or up; ex: for the chain of delays in planWake()
+uint32_t eRCaGuy_WDTimer::toUnits16(uint32_t t_ms,boolean roundUp)
+{
+  uint32_t t_unit_q8 = _t_segment_q8[WDTO_16MS]; //1/256 ms
+  uint32_t t_rem_q8 = (t_ms % t_unit_q8)*256; //split up so that t_ms*256 can't overflow
+  uint32_t units = (t_ms/t_unit_q8)*256 + t_rem_q8/t_unit_q8;
+  if (roundUp && t_rem_q8 % t_unit_q8)
+    units++;
+  return units;
+}
+
+//ms; the calibrated length of the chain of WDT delays for units16 x 16ms (see planWake()), rounded up
+uint32_t eRCaGuy_WDTimer::units16ToMs(uint32_t units16)
+{
+  uint32_t num_long = units16 >> 9; //# of 8192ms delays
+  uint32_t t_q8 = num_long*(_t_segment_q8[WDTO_8192MS] & 0xFF); //1/256 ms; the fractions of the 8192ms delays...
+  for (byte period=WDTO_16MS; period<WDTO_8192MS; period++)
+  {
+    if (units16 & (1UL << period))
+      t_q8 += _t_segment_q8[period]; //...& the shorter delays
+  }
+  return num_long*(_t_segment_q8[WDTO_8192MS] >> 8) + (t_q8 + 255)/256;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//unscheduleTimer()
+//-takes the timer off of the heap, if it's on it, and turns off the WDT once no timers are left; must be called with interrupts off
+//-if the timer had the earliest deadline, the WDT delay currently running is simply left to finish; the ISR will then
+// determine the delay for the new earliest deadline
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::unscheduleTimer(byte timerID)
+{
+  if (_timers[timerID].heapIndex!=_WDT_NO_TIMER)
+    heapRemove(_timers[timerID].heapIndex);
+  if (_heapSize==0)
+    stopSegment();
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//scheduleNextSegment()
+//-starts the WDT delay segment for the earliest deadline on the heap; the WDT must already be disabled
+//-if that deadline has already been reached (ex: a _WDT_REPEAT timer whose user function ran longer than its period),
+// the shortest possible delay is used (16ms, or 1 Timer2 tick in fine mode), so that the timer fires again right away rather than stopping
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::scheduleNextSegment(uint32_t t_now)
+{
+  if (_heapSize==0)
+  {
+    startIdle();
+    return;
+  }
+  _t_WDT_delay_remaining = (int32_t)(_timers[_heap[0]].t_wake - t_now); //ms
+  update_WDT_period(); //use the _t_WDT_delay_remaining value to determine the new _WDT_period value
+  if (_WDT_period==_DESIRED_DELAY_TOO_SHORT)
+  {
+#if WDT_FINE
+    planFineFinish(_timers[_heap[0]].t_wake,t_now,true);
+#else
+    _WDT_period = WDTO_16MS;
+#endif
+  }
+  WDT_begin(); //start the new WDT delay time
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//Time base
+//-all deadlines are in this time base, rather than in millis(), so they keep working when Timer0 is stopped (ex: in
+// power-down sleep, or if the user turns Timer0 off)
+//-it is counted in WDT delays: every time a WDT delay segment ends, the ISR adds that delay's length (_t_segment_q8[],
+// in 1/256 ms units, plus _t_segment_frac[], the next byte of it) to _t_now, so the ISR itself never needs millis()
+//-the delay lengths are calibrated against the crystal as the timers run (see setBackgroundCalibration()), & a segment 
+// which was timed counts with its measured length
+//-millis() is only used to estimate how much of the current segment has gone by (capped at the segment's length), for
+// when now() is read in the middle of a segment, or when a segment must be cut short (ex: a new timer has an earlier
+// deadline); while no timers are running, millis() alone moves the time base forward
+//-that estimate is millis() since the last anchor: the last time it was made, or the timers went idle, or sleep() woke 
+// up; so the ISR never reads millis() to start a segment
+//-------------------------------------------------------------------------------------------------------------------
+
+//ms; the time base; must be called from the ISR, or with interrupts off
+uint32_t eRCaGuy_WDTimer::timeNow()
+{
+  uint32_t t_millis = WDT_HAL_millis(); //ms
+  uint32_t t_partial = _t_anchor + (t_millis - _t_anchor_millis) - _t_now; //ms; how far past _t_now millis() says we are
+  if (_segmentRunning)
+  {
+    uint32_t t_segment = segmentLength_q8() >> 8; //ms
+    if ((int32_t)t_partial < 0)
+      t_partial = 0; //millis() was stopped for some of the time since the anchor (ex: asleep)
+    else if (t_partial > t_segment)
+      t_partial = t_segment; //millis() is ahead of the WDT, so the ISR is about to fire
+  }
+  _t_anchor = _t_now + t_partial; //the next estimate starts from this one
+  _t_anchor_millis = t_millis;
+  return _t_anchor;
+}
+
+//ms; timeNow(), extended to 64 bits with the # of times _t_now has rolled over; same rules as timeNow()
+uint64_t eRCaGuy_WDTimer::timeNow64()
+{
+  uint32_t t_now = timeNow(); //ms
+  uint32_t t_now_hi = _t_now_hi;
+  if (t_now < _t_now)
+    t_now_hi++; //the part of the current segment which has gone by rolls it over
+  return ((uint64_t)t_now_hi << 32) + t_now;
+}
+
+//add t_ms to _t_now, & count its roll-overs; must be called from the ISR, or with interrupts off
+void eRCaGuy_WDTimer::addToTimeBase(uint32_t t_ms)
+{
+  _t_now += t_ms;
+  if (_t_now < t_ms)
+    _t_now_hi++;
+}
+
+//1/256 ms; length of the WDT delay segment (or fine mode finish) which is running
+uint32_t eRCaGuy_WDTimer::segmentLength_q8()
+{
+  return segmentLength_q16() >> 8;
+}
+
+//1/65536 ms; the same, with the extra byte of precision the time base counts it with (so that the rounding of a short
+//delay's length doesn't add up, over millions of them)
+uint32_t eRCaGuy_WDTimer::segmentLength_q16()
+{
+#if WDT_FINE
+  if (_WDT_period==_WDT_FINE_FINISH)
+    return _t_fine_q16;
+#endif
+  return (_t_segment_q8[_WDT_period] << 8) | _t_segment_frac[_WDT_period];
+}
+
+//true if a measured (or saved) length of the given WDTO_* delay is within 10% of nominal; anything further off is a bad 
+//measurement (or record), & a length of 0 would even divide by zero in toUnits16()
+static boolean validSegmentLength(byte period,uint32_t t_segment_q8)
+{
+  uint32_t t_nominal_q8 = (16UL << period) << 8; //1/256 ms
+  return (t_segment_q8 >= t_nominal_q8 - t_nominal_q8/10 && t_segment_q8 <= t_nominal_q8 + t_nominal_q8/10);
+}
+
+//called by the ISR when a WDT delay segment ends
+void eRCaGuy_WDTimer::segmentDone()
+{
+  uint32_t t_segment_q16 = segmentLength_q16(); //1/65536 ms
+  
+  if (!_sleptThisSegment && _bgCalSegment)
+  {
+    //the reference counted this whole segment; average it into this delay's calibrated length, until it has 
+    //WDT_CAL_SEED_SAMPLES of them, & from then on, nudge it 1/16 of the way towards each new measurement
+    uint32_t t_measured_us = _bgCalReference() - _t_segment_start_us;
+    int32_t t_measured_q16 = (int32_t)((t_measured_us/125)*8192 + ((t_measured_us%125)*8192 + 62)/125); //us --> 1/65536 ms, rounded; split up so it can't overflow
+    int32_t t_error_q16 = t_measured_q16 - (int32_t)t_segment_q16;
+    byte samples = _calSamples[_WDT_period];
+    boolean valid; //ignore outliers, ex: if another ISR delayed this one
+    if (samples==0)
+      valid = validSegmentLength(_WDT_period,(uint32_t)t_measured_q16 >> 8);
+    else
+      valid = (labs(t_error_q16) < (int32_t)(t_segment_q16/32));
+    if (valid)
+    {
+      uint32_t t_calibrated_q16; //1/65536 ms
+      if (samples < WDT_CAL_SEED_SAMPLES)
+      {
+        samples++;
+        _calSamples[_WDT_period] = samples;
+        t_calibrated_q16 = t_segment_q16 + t_error_q16/samples; //the running mean of the samples so far
+      }
+      else
+        t_calibrated_q16 = t_segment_q16 + t_error_q16/16;
+      _t_segment_q8[_WDT_period] = t_calibrated_q16 >> 8;
+      _t_segment_frac[_WDT_period] = (byte)t_calibrated_q16;
+      t_segment_q16 = t_measured_q16; //& this segment counts with its own, true length
+    }
+  }
+  
+  t_segment_q16 += _t_now_frac;
+  addToTimeBase(t_segment_q16 >> 16);
+  _t_now_frac = (uint16_t)t_segment_q16;
+  _segmentRunning = false;
+}
+
+//true if the WDT delay segment (or fine mode finish) which is running has already ended, but its ISR is being held off (ie: interrupts are off)
+boolean eRCaGuy_WDTimer::segmentOverdue()
+{
+  if (!_segmentRunning)
+    return false;
+#if WDT_FINE
+  if (_WDT_period==_WDT_FINE_FINISH)
+    return WDT_HAL_finePending();
+#endif
+  return WDT_HAL_interruptPending();
+}
+
+//cut the WDT delay segment currently running (if any) short, keeping the part of it which has already gone by; interrupts must be off
+void eRCaGuy_WDTimer::stopSegment()
+{
+  addToTimeBase(timeNow() - _t_now);
+  if (_supervisorTimer==_WDT_NO_TIMER)
+    WDT_HAL_disable(); //in supervision mode, the WDT is left running in System Reset Mode, until the next segment starts
+#if WDT_FINE
+  WDT_HAL_fineStop();
+#endif
+  startIdle();
+}
+
+//no WDT delay segment is running anymore; the WDT must already be disabled
+void eRCaGuy_WDTimer::startIdle()
+{
+  WDT_HAL_disableInterrupt(); //clear the WatchDog Interrupt Enable (WDIE) bit to 0, in order to disable the WDT_vect interrupt!
+  _segmentRunning = false;
+  _heldOff = false; //nothing is running, so nothing can be held up; the next timer mustn't see the last one's
+  if (_t_now_frac >= 0x8000)
+    addToTimeBase(1); //round the time base to the nearest ms, since millis() alone moves it forward while idle
+  _t_now_frac = 0;
+  _t_anchor = _t_now;
+  _t_anchor_millis = WDT_HAL_millis();
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//now()
+//-ms; the library's own monotonic time base, which all timers use; unlike millis(), it keeps counting while asleep
+//-it only counts the WDT delays (& fine mode finishes) it runs, so any time the WDT ISR is held off past the end of one
+// (ex: by a user function, called from the ISR, which runs longer than the delay started right before it; or by a 
+// long noInterrupts() section) is lost from it for good, & the timers all run that much late; Timer0 can't count it 
+// either, since its own interrupt is held off too; so keep the user functions short (the delay started right before 
+// them can be as short as 16ms), or call the long ones from loop(), with setDeferred()
+//-------------------------------------------------------------------------------------------------------------------
+uint32_t eRCaGuy_WDTimer::now()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t t_now = timeNow(); //ms
+  SREG = SREG_old; //restore previous interrupt status
+  return t_now;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//syncMillis()
+//-adds the time that millis() missed while asleep (in any sleep mode which stops Timer0) back into millis(), so that 
+// millis() catches back up with now(); call it after sleep() if the rest of your code relies on millis()
+//-NOTE: micros() is NOT corrected
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::syncMillis()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  WDT_HAL_addToMillis(_t_millis_missed);
+  _t_anchor_millis += _t_millis_missed; //so that the estimate of how far along the current segment is doesn't jump
+  _t_millis_missed = 0;
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//snapshot()
+//-copies the state of the attachInterrupt() timer (see WDT_state_t), without turning interrupts off, so it doesn't add 
+// to the latency of any other ISR (ex: a UART or pin change one)
+//-seqlock style: the ISRs increment _stateGeneration once they are done changing the state, so if it changed while 
+// the state was being copied, the copy may be torn, & it is simply done again (the ISRs always run to completion, & 
+// the methods which change the state from outside of them do so with interrupts off)
+//-safe to call from anywhere, including from a user function, or another ISR
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::snapshot(WDT_state_t* state)
+{
+  byte generation;
+  do
+  {
+    generation = _stateGeneration;
+    state->t_WDT_start = _t_WDT_start;
+    state->t_WDT_end = _t_WDT_end;
+    state->t_WDT_delay_desired = _t_WDT_delay_desired;
+    state->t_WDT_delay_actual = _t_WDT_delay_actual;
+    state->t_WDT_delay_remaining = _t_WDT_delay_remaining;
+    state->WDT_period = _WDT_period;
+    state->WDT_mode = _WDT_mode;
+    state->userFuncCalls = _numUserFuncCalls;
+  } while (generation!=_stateGeneration);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//now64() & setNow()
+//-ms; now64() is the same time base as now(), but 64 bits wide, so it doesn't roll over (now() does every 49.7 days), 
+// plus an offset, which setNow() sets; ex: a time which other nodes share, from a GPS, an RTC, or a sync message
+//-atTime() & everyAligned() times are in now64() time; setNow() doesn't move the timers which are already running
+//-------------------------------------------------------------------------------------------------------------------
+uint64_t eRCaGuy_WDTimer::now64()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint64_t t_now = timeNow64() + _t_offset; //ms
+  SREG = SREG_old; //restore previous interrupt status
+  return t_now;
+}
+
+void eRCaGuy_WDTimer::setNow(uint64_t t_ms)
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  _t_offset = t_ms - timeNow64();
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//Deferred mode
+//-by default, the user functions are called right from the WDT ISR, so they run with interrupts off, & hold off every
+// other interrupt (Serial, pin change, etc) until they return
+//-in deferred mode, the ISR instead just queues one small event (WDT_event_t) per expired timer; loop() then calls
+// dispatch(), to call their user functions with interrupts on, or poll(), to handle the events itself
+//-no events are lost if loop() is slow, unlike with the single _userInterruptCalled flag, until WDT_EVENT_QUEUE_SIZE-1 
+// of them are waiting; after that, new events are dropped (the oldest ones are kept), & counted by eventOverflows()
+//-the queue is a single-producer (the ISR), single-consumer (poll()) ring buffer; each side only writes its own 
+// 1-byte index, so neither one ever needs to turn interrupts off; so only call poll() & dispatch() from one place, ex: loop()
+//-sleep() still returns after each event is queued, so "wdt.sleep(); wdt.dispatch();" in loop() works as expected
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::setDeferred(boolean deferred)
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  _deferred = deferred;
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//called by the ISR
+void eRCaGuy_WDTimer::pushEvent(byte timerID,void (*func)(),uint32_t t_event,int32_t t_delay_actual)
+{
+  byte head = _eventHead;
+  byte head_next = (head + 1) & (WDT_EVENT_QUEUE_SIZE - 1);
+  if (head_next==_eventTail)
+  {
+    _eventOverflows++; //full
+    return;
+  }
+  WDT_event_t* event = &_events[head];
+  event->timerID = timerID;
+  event->t_event = t_event;
+  event->t_delay_actual = t_delay_actual;
+  event->func = func;
+  WDT_HAL_memoryBarrier(); //the event must be written before poll() can see it
+  _eventHead = head_next;
+}
+
+boolean eRCaGuy_WDTimer::poll(WDT_event_t* event)
+{
+  byte tail = _eventTail;
+  if (tail==_eventHead)
+    return false; //empty
+  WDT_HAL_memoryBarrier(); //don't read the event before the index which says it's there
+  *event = _events[tail];
+  WDT_HAL_memoryBarrier(); //the event must be read out before the ISR can overwrite it
+  _eventTail = (tail + 1) & (WDT_EVENT_QUEUE_SIZE - 1);
+  return true;
+}
+
+//-only calls the events which were already queued when it was called; so if the user functions take longer than their 
+// periods, & the ISR queues new events while they run, it still returns (to let the rest of loop() run), rather than 
+// draining the queue forever
+byte eRCaGuy_WDTimer::dispatch()
+{
+  WDT_event_t event;
+  byte numQueued = (_eventHead - _eventTail) & (WDT_EVENT_QUEUE_SIZE - 1);
+  byte numCalled = 0;
+  while (numCalled<numQueued && poll(&event))
+  {
+    if (event.func!=NULL)
+      callUserFunc(event.timerID,event.func);
+    numCalled++;
+  }
+  return numCalled;
+}
+
+uint32_t eRCaGuy_WDTimer::eventOverflows()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t overflows = _eventOverflows;
+  SREG = SREG_old; //restore previous interrupt status
+  return overflows;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//callUserFunc()
+//-calls a timer's user function, from the ISR, or from dispatch(); with WDT_STATS, it's also timed
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::callUserFunc(byte timerID,void (*func)())
+{
+#if WDT_STATS
+  if (timerID==_statsTimer)
+  {
+    uint32_t t_start_us = WDT_HAL_micros();
+    func();
+    uint32_t t_func_us = WDT_HAL_micros() - t_start_us;
+    uint8_t SREG_old = SREG; //back up the AVR Status Register (this may be called from dispatch())
+    noInterrupts(); //prepare for critical section of code
+    if (t_func_us > _stats.t_func_max_us)
+      _stats.t_func_max_us = t_func_us;
+    if (_deferred)
+    {
+      int32_t t_period = (timerID==_WDT_CHAIN_TIMER) ? (int32_t)_chainPeriod : _timers[timerID].t_delay_desired; //ms
+      if (t_func_us/1000 >= (uint32_t)t_period)
+        _stats.overruns++;
+    }
+    else
+      _statsHeldOff = segmentOverdue(); //micros() can't time it with interrupts off; see statsPeriod()
+    SREG = SREG_old; //restore previous interrupt status
+    return;
+  }
+#else
+  (void)timerID;
+#endif
+  func();
+}
+
+#if WDT_STATS
+//-------------------------------------------------------------------------------------------------------------------
+//Timing statistics
+//-kept for one timer at a time (see setStatsTimer()), & updated by the ISR at the end of each of its periods, & by
+// callUserFunc() each time its user function runs
+//-the user function's run time is measured with micros(); NOTE: when it's called from the ISR (ie: not in deferred
+// mode), interrupts are off, so micros() can't count Timer0 overflows past the first one, & run times over ~2ms are
+// under-reported; use deferred mode (see setDeferred()) to measure long user functions
+//-so in the ISR, an overrun is instead seen from the WDT itself: the user function ran past the end of the WDT delay 
+// started right before it (its interrupt is pending), & that delay was the last one of the period, ie: the timer's 
+// next deadline went by while it ran; if the delay which ran out was an earlier one, the function may or may not have
+// run past the deadline too (neither the WDT nor Timer0 counts the time past the end of that delay), so it's not 
+// counted; ie: from the ISR, overruns can be under-counted, but never over-counted
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::setStatsTimer(byte timerID)
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  _statsTimer = timerID;
+  resetStats();
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+void eRCaGuy_WDTimer::stats(WDT_stats_t* stats)
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  *stats = _stats;
+  uint64_t t_period_sum = _t_stats_period_sum; //ms
+  SREG = SREG_old; //restore previous interrupt status
+  stats->t_period_mean = (stats->periods > 0) ? (float)t_period_sum/(float)stats->periods : 0;
+}
+
+void eRCaGuy_WDTimer::resetStats()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  memset(&_stats,0,sizeof(_stats));
+  _stats.timerID = _statsTimer;
+  _t_stats_period_sum = 0;
+  _statsWakeups = 0;
+  _statsHeldOff = false;
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//called by the ISR at the end of every period of every timer
+//-heldOff: the stats timer's user function, called from the ISR, held this ISR off past the end of the period (see callUserFunc())
+void eRCaGuy_WDTimer::statsPeriod(byte timerID,int32_t t_delay_actual,int32_t t_delay_desired,boolean heldOff)
+{
+  if (timerID!=_statsTimer)
+    return;
+  
+  if (heldOff)
+    _stats.overruns++; //its last call ran through this deadline
+  if (_stats.periods==0 || t_delay_actual < _stats.t_period_min)
+    _stats.t_period_min = t_delay_actual;
+  if (_stats.periods==0 || t_delay_actual > _stats.t_period_max)
+    _stats.t_period_max = t_delay_actual;
+  _stats.periods++;
+  _t_stats_period_sum += t_delay_actual;
+  
+  //histogram bucket; the middle one holds the errors from -WDT_STATS_BUCKET_MS/2 to +WDT_STATS_BUCKET_MS/2 (not included)
+  int32_t t_error_shifted = (t_delay_actual - t_delay_desired) + WDT_STATS_BUCKET_MS*(WDT_STATS_BUCKETS/2) + WDT_STATS_BUCKET_MS/2; //ms; >= 0 for all but the first bucket
+  byte bucket = 0;
+  if (t_error_shifted > 0)
+    bucket = (t_error_shifted/WDT_STATS_BUCKET_MS < WDT_STATS_BUCKETS) ? t_error_shifted/WDT_STATS_BUCKET_MS : WDT_STATS_BUCKETS - 1;
+  if (_stats.errorHistogram[bucket] < 0xFFFF)
+    _stats.errorHistogram[bucket]++;
+  
+  _stats.wakeups += _statsWakeups;
+  if (_statsWakeups > _stats.wakeups_max)
+    _stats.wakeups_max = _statsWakeups;
+  _statsWakeups = 0;
+}
+#endif //WDT_STATS
+
+//-------------------------------------------------------------------------------------------------------------------
+//calibrate()
+//-measures the actual length of each WDT delay, from WDTO_16MS up to maxPeriod, against a reference clock: micros() by 
+// default (ie: the crystal or resonator), or reference_us(), ex: a function which counts the edges of an external 
+// reference (a 32.768kHz RTC output, GPS PPS, etc) on a pin & returns that count in us
+//-the WDT oscillator is typically ~0.5-0.8% slow (see the table at the top of eRCaGuy_WDTimer.h) & this changes with 
+// the prescaler, the supply voltage & the temperature; once calibrated, the time base (see now()) & update_WDT_period() 
+// use the measured lengths, so long running timers are accurate to the reference, even while asleep
+//-the delays longer than maxPeriod are not measured, but extrapolated from the maxPeriod one; by default, this takes ~7 seconds
+//-blocks until done, with interrupts on; no timers can be running (returns false right away if any are)
+//-returns false, & leaves the old calibration as is, if any of the delays measured is off by more than 10% from nominal
+//-------------------------------------------------------------------------------------------------------------------
+boolean eRCaGuy_WDTimer::calibrate(byte maxPeriod,uint32_t (*reference_us)())
+{
+  uint32_t segment_q16[10]; //1/65536 ms
+  boolean valid = true;
+  if (maxPeriod > WDTO_8192MS)
+    maxPeriod = WDTO_8192MS;
+  
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  if (_heapSize>0 || _chain!=NULL || _calibrating)
+  {
+    SREG = SREG_old; //restore previous interrupt status
+    return false;
+  }
+  _calReference = (reference_us!=NULL) ? reference_us : WDT_HAL_micros;
+  _calibrating = true;
+  SREG = SREG_old; //restore previous interrupt status
+  
+  for (byte period=WDTO_16MS; period<=maxPeriod; period++)
+  {
+    //measure ~1 second's worth of the short delays, & 1 of each of the long ones; the ISR time stamps every interrupt 
+    //& restarts the WDT right away, just like it does when the timers are running
+    byte numSegments = (period < WDTO_1024MS) ? (64 >> period) : 1;
+    noInterrupts();
+    _calPeriod = period;
+    _calTicks = 0;
+    WDT_HAL_begin(period);
+    interrupts();
+    while (_calTicks < numSegments + 1) //the first interrupt only marks the start of the measurement
+      WDT_HAL_busyWait();
+    
+    noInterrupts();
+    uint32_t t_measured_us = _t_cal_last_us - _t_cal_first_us;
+    interrupts();
+    segment_q16[period] = ((t_measured_us/125)*8192 + (t_measured_us%125)*8192/125)/numSegments; //us --> 1/65536 ms; split up so it can't overflow
+    if (!validSegmentLength(period,segment_q16[period] >> 8))
+      valid = false;
+  }
+  for (byte period=maxPeriod+1; period<=WDTO_8192MS; period++)
+    segment_q16[period] = segment_q16[maxPeriod] << (period - maxPeriod);
+  
+  noInterrupts();
+  WDT_HAL_disable();
+  WDT_HAL_disableInterrupt();
+  _calibrating = false;
+  if (valid)
+  {
+    for (byte i=0; i<10; i++)
+    {
+      _t_segment_q8[i] = segment_q16[i] >> 8;
+      _t_segment_frac[i] = (byte)segment_q16[i];
+      _calSamples[i] = WDT_CAL_SEED_SAMPLES; //the background calibration only needs to follow it from here
+    }
+  }
+  SREG = SREG_old; //restore previous interrupt status
+  return valid;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//calibrationTick()
+//-called by the WDT ISR, instead of processTimers(), while calibrate() is running
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::calibrationTick()
+{
+  uint32_t t_us = _calReference();
+  WDT_HAL_begin(_calPeriod); //start the next delay right away; the time it takes to get here is part of every real delay too
+  if (_calTicks==0)
+    _t_cal_first_us = t_us;
+  _t_cal_last_us = t_us;
+  _calTicks++;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//calibrationFactor()
+//-actual/nominal length of the given WDTO_* delay, as currently calibrated; 1.0 until calibrated; 0 if period is invalid
+//-------------------------------------------------------------------------------------------------------------------
+float eRCaGuy_WDTimer::calibrationFactor(byte period)
+{
+  if (period > WDTO_8192MS)
+    return 0;
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t segment_q8 = _t_segment_q8[period]; //1/256 ms
+  SREG = SREG_old; //restore previous interrupt status
+  return (float)segment_q8/(float)((16UL << period) << 8);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//saveCalibration() & loadCalibration()
+//-store the calibration in EEPROM, from address to address+WDT_CAL_EEPROM_SIZE-1, & read it back, ex: at every startup, 
+// so that calibrate() only needs to be run once (or once in a while)
+//-loadCalibration() returns false, & leaves the calibration as is, if there is no valid record at that address, or if 
+// any of its delays is off by more than 10% from nominal, like calibrate()
+//-------------------------------------------------------------------------------------------------------------------
+static byte calibrationChecksum(const WDT_calibration_t* record)
+{
+  byte sum = 0;
+  const byte* bytes = (const byte*)record;
+  for (byte i=0; i<(byte)offsetof(WDT_calibration_t,checksum); i++)
+    sum += bytes[i];
+  return sum;
+}
+
+void eRCaGuy_WDTimer::saveCalibration(int address)
+{
+  WDT_calibration_t record;
+  memset(&record,0,sizeof(record)); //so that any padding bytes are always the same too
+  record.magic[0] = 'W';
+  record.magic[1] = 'C';
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  for (byte i=0; i<10; i++)
+    record.segment_q8[i] = _t_segment_q8[i];
+  SREG = SREG_old; //restore previous interrupt status
+  record.checksum = calibrationChecksum(&record);
+  WDT_HAL_eepromWrite(address,&record,sizeof(record));
+}
+
+boolean eRCaGuy_WDTimer::loadCalibration(int address)
+{
+  WDT_calibration_t record;
+  WDT_HAL_eepromRead(address,&record,sizeof(record));
+  if (record.magic[0]!='W' || record.magic[1]!='C' || record.checksum!=calibrationChecksum(&record))
+    return false;
+  for (byte i=0; i<10; i++)
+  {
+    if (!validSegmentLength(i,record.segment_q8[i])) //the same check as calibrate()'s, ex: for a record saved by an older version, or for another mcu
+      return false;
+  }
+  
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  for (byte i=0; i<10; i++)
+  {
+    _t_segment_q8[i] = record.segment_q8[i];
+    _t_segment_frac[i] = 0;
+    _calSamples[i] = WDT_CAL_SEED_SAMPLES;
+  }
+  SREG = SREG_old; //restore previous interrupt status
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//setBackgroundCalibration()
+//-WDT delay segments which run to the end while the mcu is awake (or in SLEEP_MODE_IDLE) are timed against micros(), 
+// or reference_us(); each one timed counts in the time base with its measured length, & is averaged into the delay's 
+// calibrated length (its first WDT_CAL_SEED_SAMPLES measurements), or moves it 1/16 of the way towards the measurement
+// (after that); so the calibration follows slow changes of temperature & supply voltage, without stopping the timers 
+// to run calibrate()
+//-mode: 
+// -_WDT_CAL_AUTO (the default): the first WDT_CAL_SEED_SAMPLES segments of each delay are timed, then only 1 in 
+//  WDT_CAL_SAMPLE_EVERY; so the time base is as accurate as the crystal from the start, without calibrate(), for 2 
+//  reference_us() calls per WDT_CAL_SAMPLE_EVERY segments
+// -_WDT_CAL_EVERY: every segment is timed; costs one reference_us() call at the start & end of every segment, plus a
+//  32-bit divide, in the ISR
+// -_WDT_CAL_OFF: none are; ex: if Timer0 is turned off; the delays then keep their nominal (or calibrate()) lengths
+//-NOTE: so by default, the ISR still reads micros() (ie: Timer0) on the segments it times; for an ISR which never 
+// touches Timer0, calibrate() (or loadCalibration()) once, then select _WDT_CAL_OFF
+//-selecting _WDT_CAL_AUTO (again) seeds every delay afresh, from its next WDT_CAL_SEED_SAMPLES segments; ex: after a 
+// big change of temperature, which the 1/16 steps would take a while (~1 hour, with a 1 second period) to follow
+//-segments which the mcu slept through are skipped, since micros() stops then too; so with a deep sleep mode, it only 
+// learns from the segments that happen to run while awake; except that, with _WDT_CAL_AUTO, sleep() sleeps through the
+// seed samples in SLEEP_MODE_IDLE, so that even a sketch which is always asleep gets calibrated
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::setBackgroundCalibration(byte mode,uint32_t (*reference_us)())
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  _bgCalReference = (reference_us!=NULL) ? reference_us : WDT_HAL_micros;
+  _calMode = mode;
+  if (mode==_WDT_CAL_AUTO)
+  {
+    for (byte i=0; i<10; i++)
+      _calSamples[i] = 0;
+  }
+  _bgCalSegment = false; //the segment currently running (if any) wasn't timed from its start
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//sleep()
+//-puts the mcu to sleep, in the mode set by setSleepMode(), until the next time a user function gets called (by any timer)
+//-the WDT ISR wakes the mcu up at the end of every WDT delay segment, but if no user function was due yet, this goes
+// right back to sleep, without returning to your loop(); so, ex: a 1000ms period costs 6 short wakeups, but only 1 return
+//-returns right away if no timers are running, since nothing would ever wake the mcu up
+//-returns the time spent asleep in this call, in ms (the part of sleptTime() it added)
+//-in any sleep mode other than SLEEP_MODE_IDLE, Timer0 stops, so millis() stops counting while asleep; the timers 
+// themselves don't care (see now()), but millis() itself stays behind, unless you call syncMillis()
+//-with WDT_SAMPLER, while a sample is being taken, this sleeps in SLEEP_MODE_ADC instead, which starts the conversion
+// & keeps the ADC clock running; & the _WDT_SLEEP_ADC_OFF option is ignored while the sampler runs, since the sampler 
+// turns the ADC off between samples itself
+//-must be called with interrupts on
+//-------------------------------------------------------------------------------------------------------------------
+uint32_t eRCaGuy_WDTimer::sleep()
+{
+  uint32_t t_asleep = 0; //ms
+  byte ADCSRA_old = 0;
+  boolean adcOff = (_sleepOptions & _WDT_SLEEP_ADC_OFF);
+  if (_beforeSleep!=NULL)
+    _beforeSleep();
+#if WDT_SAMPLER
+  adcOff = adcOff && _samplerTimer==_WDT_NO_TIMER;
+  _inSleep = true; //from now on, a sample is started by going to sleep
+#endif
+  if (adcOff)
+    ADCSRA_old = WDT_HAL_adcOff();
+  
+  byte numUserFuncCalls_start = _numUserFuncCalls;
+  while (true)
+  {
+    noInterrupts(); //check if we should sleep, & go to sleep, with no chance of an interrupt in between
+    if (_numUserFuncCalls!=numUserFuncCalls_start || (_heapSize==0 && _chain==NULL))
+      break; //a user function was called, or there are no timers left to ever wake us up
+    uint32_t t_sleep = timeNow(); //ms
+    uint32_t t_sleep_millis = WDT_HAL_millis(); //ms
+    byte sleepMode = _sleepMode;
+#if WDT_FINE
+    if (_segmentRunning && _WDT_period==_WDT_FINE_FINISH)
+      sleepMode = SLEEP_MODE_IDLE; //Timer2 must keep counting
+#endif
+    if (_segmentRunning && _bgCalSegment && _calMode==_WDT_CAL_AUTO && _calSamples[_WDT_period] < WDT_CAL_SEED_SAMPLES)
+      sleepMode = SLEEP_MODE_IDLE; //keep Timer0 counting, so this segment seeds its delay's calibration (see setBackgroundCalibration())
+#if WDT_SAMPLER
+    if (_sampleState==_WDT_SAMPLE_WAITING && sleepMode==SLEEP_MODE_IDLE)
+    {
+      WDT_HAL_adcStartConversion(); //SLEEP_MODE_IDLE doesn't start it, but the ADC keeps running in it
+      _sampleState = _WDT_SAMPLE_CONVERTING;
+    }
+    else if (_sampleState!=_WDT_SAMPLE_IDLE && sleepMode!=SLEEP_MODE_IDLE)
+    {
+      sleepMode = SLEEP_MODE_ADC; //starts the conversion, if it's _WDT_SAMPLE_WAITING, & wakes us up at its end
+      _sampleState = _WDT_SAMPLE_CONVERTING;
+    }
+#endif
+    if (sleepMode!=SLEEP_MODE_IDLE)
+      _sleptThisSegment = true; //Timer0 is about to stop
+    WDT_HAL_sleep(sleepMode,_sleepOptions & _WDT_SLEEP_BOD_OFF); //zzz...; interrupts are back on after waking up
+    noInterrupts();
+    uint32_t t_slept = timeNow() - t_sleep; //ms
+    _t_asleep += t_slept;
+    uint32_t t_counted = WDT_HAL_millis() - t_sleep_millis; //ms; the part of it which millis() saw
+    if (t_counted < t_slept)
+      _t_millis_missed += t_slept - t_counted; //Timer0 was stopped; keep track of it for syncMillis()
+    interrupts();
+    t_asleep += t_slept;
+  }
+#if WDT_SAMPLER
+  _inSleep = false;
+  if (_sampleState==_WDT_SAMPLE_WAITING)
+  {
+    WDT_HAL_adcStartConversion(); //the ISR which woke us up left it for sleep() to start; but we're done sleeping
+    _sampleState = _WDT_SAMPLE_CONVERTING;
+  }
+#endif
+  interrupts();
+  
+  if (adcOff)
+    WDT_HAL_adcRestore(ADCSRA_old);
+  if (_afterWake!=NULL)
+    _afterWake();
+  return t_asleep;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//setSleepMode()
+//-sleepMode: any of the SLEEP_MODE_* values from <avr/sleep.h>; the default is SLEEP_MODE_PWR_DOWN, which uses the least power
+//-options: 0, or any of _WDT_SLEEP_ADC_OFF & _WDT_SLEEP_BOD_OFF, OR'ed together
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::setSleepMode(byte sleepMode,byte options)
+{
+  _sleepMode = sleepMode;
+  _sleepOptions = options;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//setSleepHooks()
+//-beforeSleep() is called once at the start of each sleep() call, & afterWake() once at the end of it, ex: to turn
+// off & back on peripherals; pass NULL for either one to not use it
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::setSleepHooks(void (*beforeSleep)(),void (*afterWake)())
+{
+  _beforeSleep = beforeSleep;
+  _afterWake = afterWake;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//Duty cycle
+//-awakeTime() + sleptTime() = total time since the last resetDutyCycle() (or since startup)
+//-sleptTime() only counts time spent inside sleep()
+//-------------------------------------------------------------------------------------------------------------------
+uint32_t eRCaGuy_WDTimer::awakeTime()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t t_awake = timeNow() - _t_duty_start - _t_asleep; //ms
+  SREG = SREG_old; //restore previous interrupt status
+  return t_awake;
+}
+
+uint32_t eRCaGuy_WDTimer::sleptTime()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t t_asleep = _t_asleep; //ms
+  SREG = SREG_old; //restore previous interrupt status
+  return t_asleep;
+}
+
+float eRCaGuy_WDTimer::dutyCycle()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  uint32_t t_total = timeNow() - _t_duty_start; //ms
+  uint32_t t_asleep = _t_asleep; //ms
+  SREG = SREG_old; //restore previous interrupt status
+  if (t_total==0)
+    return 100.0;
+  return (float)(t_total - t_asleep)*100.0/(float)t_total;
+}
+
+void eRCaGuy_WDTimer::resetDutyCycle()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  _t_duty_start = timeNow();
+  _t_asleep = 0;
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//beginChain()
+//-called by WDTimer<PeriodMs>::begin() to start calling func at the end of every period, made of: numLongSegments x 8192ms,
+// then the precomputed chain of shorter delays, then (every so often) one extra 16ms delay to pay back the remainder
+//-any timers started with attachInterrupt(), timedInterrupt() or addTimer() are stopped, since the chain owns the WDT
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::beginChain(void (*func)(),const byte* chain,uint32_t numLongSegments,byte remainder_ms,uint32_t period_ms)
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  
+  //stop all of the other timers
+  while (_heapSize>0)
+    heapRemove(0);
+  for (byte i=_WDT_LEGACY_TIMER+1; i<WDT_MAX_TIMERS; i++)
+    _timers[i].func = NULL; //free the slot
+  _supervisorTimer = _WDT_NO_TIMER; //supervision mode too
+#if WDT_SAMPLER
+  if (_samplerTimer!=_WDT_NO_TIMER)
+    stopSampling(); //& the sampler
+#endif
+  stopSegment();
+  
+  _chainFunc = func;
+  _chainPeriod = period_ms;
+  _chainNumLong = numLongSegments;
+  _chainRemainder = remainder_ms;
+  _chainRemainderSum = 0;
+  _chain = chain;
+  _t_chain_start = _t_now;
+  restartChain();
+  _WDT_period = nextChainSegment(); //every chain has at least one segment
+  WDT_begin();
+  
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//stopChain()
+//-stops the WDTimer<PeriodMs> which is running, if any; the other timers can then be used again
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::stopChain()
+{
+  uint8_t SREG_old = SREG; //back up the AVR Status Register
+  noInterrupts(); //prepare for critical section of code
+  if (_chain!=NULL)
+  {
+    _chain = NULL;
+    stopSegment();
+  }
+  SREG = SREG_old; //restore previous interrupt status
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//stepChain()
+//-called by the WDT ISR, instead of processTimers(), while a WDTimer<PeriodMs> is running
+//-starts the next delay of the chain; once the whole chain is done, starts the chain over & calls the user function
+//-no update_WDT_period(), no heap & no millis(); the rest of the per-segment work is in segmentDone(), shared with 
+// processTimers(): adding the delay to the time base, & on the segments the background calibration times (see 
+// setBackgroundCalibration()), reading its reference clock, & a few 32-bit multiplies & divides
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::stepChain()
+{
+  segmentDone(); //add the WDT delay which just ended to the time base
+#if WDT_STATS
+  _statsWakeups++;
+  boolean statsHeldOff = _statsHeldOff; //see callUserFunc()
+  _statsHeldOff = false;
+#endif
+  byte period = nextChainSegment();
+  if (period!=_DESIRED_DELAY_TOO_SHORT)
+  {
+    _WDT_period = period;
+    WDT_begin(); //start the next delay of this period
+    return;
+  }
+  
+  //the period is over; start the next one right away, so that the user function's run time doesn't delay it, then call the user function
+  restartChain();
+  _WDT_period = nextChainSegment();
+  WDT_begin();
+  _userInterruptCalled = true;
+  _numUserFuncCalls++;
+  int32_t t_delay_actual = (int32_t)(_t_now - _t_chain_start); //ms
+  _t_chain_start = _t_now;
+#if WDT_STATS
+  statsPeriod(_WDT_CHAIN_TIMER,t_delay_actual,(int32_t)_chainPeriod,statsHeldOff);
+#endif
+  if (_deferred)
+    pushEvent(_WDT_CHAIN_TIMER,_chainFunc,_t_now,t_delay_actual);
+  else
+    callUserFunc(_WDT_CHAIN_TIMER,_chainFunc);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//restartChain()
+//-go back to the start of the chain, for a new period
+//-the remainder (PeriodMs%16) of every period is added up; each time the sum reaches 16ms, that period gets one extra 16ms delay
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::restartChain()
+{
+  _chainLongLeft = _chainNumLong;
+  _chainIndex = 0;
+  _chainRemainderSum += _chainRemainder;
+  _chainExtra = (_chainRemainderSum >= 16);
+  if (_chainExtra)
+    _chainRemainderSum -= 16;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//nextChainSegment()
+//-returns the WDTO_* period of the next delay of the current period, or _DESIRED_DELAY_TOO_SHORT if the period is over
+//-------------------------------------------------------------------------------------------------------------------
+byte eRCaGuy_WDTimer::nextChainSegment()
+{
+  if (_chainLongLeft>0)
+  {
+    _chainLongLeft--;
+    return WDTO_8192MS;
+  }
+  byte period = _chain[_chainIndex];
+  if (period!=_DESIRED_DELAY_TOO_SHORT)
+  {
+    _chainIndex++;
+    return period;
+  }
+  if (_chainExtra)
+  {
+    _chainExtra = false;
+    return WDTO_16MS;
+  }
+  return _DESIRED_DELAY_TOO_SHORT;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//WDT_begin()
+//-INPUT: requires the public member (acts like a global variable within the class) _WDT_period to already by updated
+//-OUTPUT: none; but prepares the WDT interrupt to go off (or, for _WDT_FINE_FINISH, the Timer2 one)
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::WDT_begin()
+{
+#if WDT_FINE
+  if (_WDT_period==_WDT_FINE_FINISH)
+  {
+    _t_fine_q16 = WDT_HAL_fineBegin(_t_fine_us)*8192/125; //us --> 1/65536 ms
+    if (_supervisorTimer!=_WDT_NO_TIMER)
+      WDT_HAL_armReset(WDTO_8192MS); //keep the reset armed, but well clear of the end of this finish (& the user functions after it)
+    _bgCalSegment = false; //only the WDT delays are calibrated
+    _sleptThisSegment = false;
+    _segmentRunning = true;
+    return;
+  }
+#endif
+  
+  //set up the Watchdog Timer (WDT)
+  WDT_HAL_begin(_WDT_period); //enable the WD Timer in Interrupt Mode, with the specified timeout period, & let it start counting
+  
+  //time this segment against the reference? (see setBackgroundCalibration())
+  _bgCalSegment = (_calMode==_WDT_CAL_EVERY);
+  if (_calMode==_WDT_CAL_AUTO)
+  {
+    if (_calSamples[_WDT_period] < WDT_CAL_SEED_SAMPLES)
+      _bgCalSegment = true;
+    else if (--_calCountdown==0)
+    {
+      _calCountdown = WDT_CAL_SAMPLE_EVERY;
+      _bgCalSegment = true;
+    }
+  }
+  if (_bgCalSegment)
+    _t_segment_start_us = _bgCalReference();
+  _sleptThisSegment = false;
+  _segmentRunning = true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//update_WDT_period()
+//-use the _t_WDT_delay_remaining value to determine the new _WDT_period value
+//-INPUT: requires the private member (acts like a global variable within the class) _t_WDT_delay_remaining to already by updated
+//-OUTPUT: updates the public member _WDT_period
+//-------------------------------------------------------------------------------------------------------------------
+void eRCaGuy_WDTimer::update_WDT_period()
+{
+  int32_t _t_WDT_delay_remaining_cpy = _t_WDT_delay_remaining; //copy out the volatile variable once; no critical section needed, since this only ever runs in the ISR, or with interrupts off
+  
+  //the longest WDT delay which fits in the time remaining, using the calibrated delay lengths (see calibrate()), 
+  //so that it never overshoots, no matter how slow or fast the WDT oscillator actually is
+#if WDT_FINE
+  const int32_t t_margin = 2; //ms; the delay lengths (& the time remaining) are rounded down to the ms, so keep 2ms in hand to never overshoot; Timer2 does the rest
+#else
+  const int32_t t_margin = 0; //ms
+#endif
+  for (byte period=WDTO_8192MS; period>WDTO_16MS; period--)
+  {
+    if (_t_WDT_delay_remaining_cpy >= (int32_t)(_t_segment_q8[period] >> 8) + t_margin)
+    {
+      _WDT_period = period;
+      return;
+    }
+  }
+#if WDT_FINE
+  if (_t_WDT_delay_remaining_cpy >= (int32_t)(_t_segment_q8[WDTO_16MS] >> 8) + t_margin) //in fine mode, the WDT never overshoots; Timer2 does whatever is left (see planFineFinish())
+#else
+  if (_t_WDT_delay_remaining_cpy > 0 && _t_WDT_delay_remaining_cpy*65536L - (int32_t)_t_now_frac >= (int32_t)(_t_segment_q8[WDTO_16MS] << 7)) //ie: >= half of the 16ms delay (from the true time, incl. the time base's fraction of a ms). If the desired delay is 8ms, then I will delay 16, and I will have delayed *8 too many*.  
+																							 //If the desired delay is 9ms, then I will delay 16, which is *7 too many*. If the desired delay is 7ms, 
+																							 //then I will not delay at all, which is *7ms too few.*
+                                               //So, with this statement as-is, the precision is only +8ms/-7ms. 
+                                               //Ie: For any given desired_delay in ms, you will delay somewhere between 8ms too many, and 7ms too few.
+#endif
+    _WDT_period = WDTO_16MS;
+  else //don't delay at all
+    _WDT_period = _DESIRED_DELAY_TOO_SHORT; //set to indicate the delay is too short
+} //end of update_WDT_period()
+
+#if WDT_FINE
+//-------------------------------------------------------------------------------------------------------------------
+//planFineFinish()
+//-fine mode: once the WDT can't do any more of the delay (see update_WDT_period()), plan a Timer2 finish for the rest of it; the
+// time left (until t_wake) is counted from the end of the last segment, including the fraction of a ms of the time base (_t_now_frac)
+//-returns true & sets _WDT_period to _WDT_FINE_FINISH, for WDT_begin(), unless the deadline is within half a Timer2
+// tick, ie: it's due now; with overdueOK, a 1 tick finish is planned even then (ex: a timer which is already late)
+//-------------------------------------------------------------------------------------------------------------------
+boolean eRCaGuy_WDTimer::planFineFinish(uint32_t t_wake,uint32_t t_now,boolean overdueOK)
+{
+  int32_t t_remaining_us = 0; //us
+  if ((int32_t)(t_wake - t_now) > 0) //a deadline which is long gone would overflow the math below
+    t_remaining_us = (int32_t)(t_wake - t_now)*1000 - (int32_t)(_t_now_frac*125UL/8192); //< ~18ms here, so this can't overflow
+  if (t_remaining_us < (int32_t)(WDT_HAL_FINE_RESOLUTION_US/2))
+  {
+    if (!overdueOK)
+      return false;
+    t_remaining_us = WDT_HAL_FINE_RESOLUTION_US;
+  }
+  _t_fine_us = t_remaining_us;
+  _WDT_period = _WDT_FINE_FINISH;
+  return true;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------
+//Deadline heap
+//-a binary min-heap of timer IDs in the _heap array, ordered by deadline, so that _heap[0] always expires next
+//-each timer stores its own position in the heap (heapIndex), so that any timer can be removed in O(log N), not just the first one
+//-deadlines are compared by their signed difference, so the ordering stays correct when millis() rolls over
+//-all of these must be called from the ISR, or with interrupts off
+//-------------------------------------------------------------------------------------------------------------------
+boolean eRCaGuy_WDTimer::deadlineBefore(byte heapIndex1,byte heapIndex2)
+{
+  return (int32_t)(_timers[_heap[heapIndex1]].t_wake - _timers[_heap[heapIndex2]].t_wake) < 0;
+}
+
+void eRCaGuy_WDTimer::heapSwap(byte heapIndex1,byte heapIndex2)
+{
+  byte timerID = _heap[heapIndex1];
+  _heap[heapIndex1] = _heap[heapIndex2];
+  _heap[heapIndex2] = timerID;
+  _timers[_heap[heapIndex1]].heapIndex = heapIndex1;
+  _timers[_heap[heapIndex2]].heapIndex = heapIndex2;
+}
+
+void eRCaGuy_WDTimer::heapSiftUp(byte heapIndex)
+{
+  while (heapIndex>0)
+  {
+    byte parent = (heapIndex - 1)/2;
+    if (!deadlineBefore(heapIndex,parent))
+      break;
+    heapSwap(heapIndex,parent);
+    heapIndex = parent;
+  }
+}
+
+void eRCaGuy_WDTimer::heapSiftDown(byte heapIndex)
+{
+  while (true)
+  {
+    byte child = 2*heapIndex + 1;
+    if (child>=_heapSize)
+      break;
+    if (child+1<_heapSize && deadlineBefore(child+1,child))
+      child++; //use the child with the earlier deadline
+    if (!deadlineBefore(child,heapIndex))
+      break;
+    heapSwap(heapIndex,child);
+    heapIndex = child;
+  }
+}
+
+void eRCaGuy_WDTimer::heapInsert(byte timerID)
+{
+  byte heapIndex = _heapSize++;
+  _heap[heapIndex] = timerID;
+  _timers[timerID].heapIndex = heapIndex;
+  heapSiftUp(heapIndex);
+}
+
+void eRCaGuy_WDTimer::heapRemove(byte heapIndex)
+{
+  _timers[_heap[heapIndex]].heapIndex = _WDT_NO_TIMER;
+  _heapSize--;
+  if (heapIndex==_heapSize)
+    return; //it was the last one; nothing to fill in
+  
+  //fill the hole with the last timer on the heap, then move that timer up or down to where it belongs
+  _heap[heapIndex] = _heap[_heapSize];
+  _timers[_heap[heapIndex]].heapIndex = heapIndex;
+  if (heapIndex>0 && deadlineBefore(heapIndex,(heapIndex - 1)/2))
+    heapSiftUp(heapIndex);
+  else
+    heapSiftDown(heapIndex);
+}
@@ -5,11 +5,27 @@ By Gabriel Staples
 Website: http://electricrcaircraftguy.blogspot.com
 Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
 Written: 4 Aug 2014
-Updated: 5 Aug 2014
+Updated: 16 Oct 2026
 */
 
 /*
 History (newest on top)
+20261016 - the time stamps & durations are now fixed-width (uint32_t & int32_t, ie: the same unsigned long & long as before, on an AVR), so the PC simulator runs the same 32-bit arithmetic & roll-overs
+20261016 - added an optional low-power sampler (compiled in with WDT_SAMPLER 1): beginSampler() takes one ADC sample per period, in ADC noise reduction sleep, into a double buffer, & only wakes the user code up (batch handler, or readBatch()) once per full batch
+20261016 - added snapshot(), a tear-free copy of the attachInterrupt() timer's state which never turns interrupts off (seqlock style); the raw _t_WDT_*, _WDT_period & _WDT_mode members are now private; update_WDT_period() no longer toggles SREG
+20261016 - added absolute & phase-aligned timers, atTime() & everyAligned(), on a 64-bit time base (now64(), setNow()) which doesn't roll over
+20261016 - added supervision mode (beginSupervision()): the WDT reset stays armed behind the WDT interrupt, & registered tasks check in once per window with checkIn(); stalled tasks are recorded in .noinit RAM
+20261016 - added a per-timer overrun policy for _WDT_REPEAT timers (catch up, with a cap; skip & stay phase-aligned; or re-anchor), with missed & coalesced period counters; a call whose deadline went by while the user functions held the WDT ISR off (seen from the WDT's own pending interrupt) counts as missed
+20261016 - added an optional slack (tolerance) argument to attachInterrupt(), timedInterrupt() & addTimer(); each period then ends at the point within +/-slack which takes the fewest WDT wakeups, while the long term average period stays exact
+20261016 - added an optional fine mode (compiled in with WDT_FINE 1), which finishes each delay with a short Timer2 compare match instead of rounding it to 16ms, for sub-ms precision; delays from 1ms up are then valid
+20261016 - added optional timing statistics (compiled in with WDT_STATS 1): period error histogram, min/max/mean period, wakeups per period, user function run time & overruns, read with stats()
+20261016 - added an optional deferred mode (setDeferred()), in which the ISR only queues an event for each expired timer, & poll()/dispatch() run them later from loop()
+20261016 - added calibrate(), which measures every WDT delay against micros() (or any other us reference), plus EEPROM save/load of the results & background recalibration; the time base & update_WDT_period() now use the calibrated delay lengths
+20261016 - the timers now keep their own time base, now(), counted in WDT delays (which calibrate themselves against the crystal as they run, by default; see setBackgroundCalibration()), so they keep working while millis() is stopped (ex: in power-down sleep); added syncMillis()
+20261016 - added the WDTimer<PeriodMs> template, which plans a fixed period's chain of WDT delays at compile time, so the ISR just steps through a constant table
+20261016 - added an opt-in sleep() method, which sleeps (power-down by default) between WDT delay segments, with ADC/BOD/user hooks & awake-vs-asleep duty cycle reporting; it returns the time it slept
+20261016 - moved all WDT register & millis() accesses behind a thin HAL (eRCaGuy_WDTimer_HAL.h), so the library can run on a PC simulator (extras/host)
+20261016 - added a fixed-capacity, deadline-ordered timer queue (min-heap) so that many independent timers can share the single WDT_vect ISR
 20140805 - library first written
 */
 
@@ -75,6 +91,9 @@ WDTO_15MS     16 ms                16 ms               15.914 ms
 #else
  #include <WProgram.h>
 #endif
+#ifndef WDT_HOST_SIM
+ #include <avr/sleep.h> //for the SLEEP_MODE_* values used with setSleepMode()
+#endif
 
 //macros/Defines
 //use the exact ms delay values in the names, deduced from Table 11-2 in the datasheet, rather than the rounded values
@@ -92,11 +111,155 @@ WDTO_15MS     16 ms                16 ms               15.914 ms
 #define WDTO_8192MS 9
 
 #define _DESIRED_DELAY_TOO_SHORT 0xFF //arbitrary byte value >9 (in decimal) to help me know this
+#define _WDT_FINE_FINISH 0xFE //_WDT_period value for the fine mode's Timer2 finish, rather than a WDT delay
+
+//Fine mode
+//-off by default: the WDT can only do multiples of 16ms, so each delay is only precise to +8/-7ms (see update_WDT_period())
+//-with fine mode on (change the 0 below to a 1, or build with -DWDT_FINE=1), the WDT still does all of each delay it
+// can, but the last part of it (<16ms) is done with a one-shot Timer2 compare match, to within 1 Timer2 tick (64us at 16MHz);
+// so each delay is precise to ~0.1ms (w.r.t. the calibrated WDT delays; see calibrate()), & delays from 1ms up are valid
+//-the library then owns Timer2: no tone(), & no analogWrite() on pins 3 & 11 (on an ATmega328)
+//-Timer2 stops in every sleep mode but SLEEP_MODE_IDLE, so sleep() uses SLEEP_MODE_IDLE during each short finish
+#ifndef WDT_FINE
+ #define WDT_FINE 0
+#endif
 
 //Watchdog Timer modes
 #define _WDT_DO_ONCE 0 //default mode
 #define _WDT_REPEAT 1
 
+//_WDT_REPEAT overrun policies (see setOverrunPolicy())
+#define _WDT_OVERRUN_CATCH_UP 0 //default; call the user function once for every missed period, back to back, up to a cap
+#define _WDT_OVERRUN_SKIP 1 //skip the missed periods; the next call is at the next deadline which is still ahead (same phase)
+#define _WDT_OVERRUN_REANCHOR 2 //start the next period now
+
+//Timer queue
+//-all timers share the one Watchdog Timer; they are kept in a min-heap ordered by deadline, and the WDT is always programmed
+// for the earliest deadline only.  All storage is static (no malloc).
+//-timer ID 0 is reserved for the attachInterrupt()/timedInterrupt() methods; addTimer() hands out IDs 1 to WDT_MAX_TIMERS-1
+#ifndef WDT_MAX_TIMERS
+ #define WDT_MAX_TIMERS 4 //max # of simultaneous timers, including the reserved one; each one costs 34 bytes of SRAM
+#endif
+#define _WDT_LEGACY_TIMER 0 //ID of the timer used by attachInterrupt()/timedInterrupt()
+#define _WDT_NO_TIMER 0xFF //returned by addTimer() when no timer could be started; also marks a timer that is not in the heap
+
+//Sleep options (see setSleepMode())
+#define _WDT_SLEEP_ADC_OFF 0x01 //turn the ADC off while asleep (it draws ~100uA in power-down otherwise), & back on after waking up
+#define _WDT_SLEEP_BOD_OFF 0x02 //turn the Brown-Out Detector off while asleep (only on mcus which support it, ex: ATmega328P)
+
+//Deferred mode (see setDeferred())
+#ifndef WDT_EVENT_QUEUE_SIZE
+ #define WDT_EVENT_QUEUE_SIZE 8 //# of events the ISR can queue up before loop() must dispatch them; must be a power of 2, up to 128; each one costs 11 bytes of SRAM
+#endif
+#if (WDT_EVENT_QUEUE_SIZE & (WDT_EVENT_QUEUE_SIZE - 1)) != 0 || WDT_EVENT_QUEUE_SIZE > 128
+ #error "WDT_EVENT_QUEUE_SIZE must be a power of 2, up to 128"
+#endif
+#define _WDT_CHAIN_TIMER 0xFE //timer ID of the events of a WDTimer<PeriodMs>
+
+//Timing statistics (see stats())
+//-off by default, since they cost ~60 bytes of SRAM, & some time in the ISR; to turn them on, change the 0 below to a 1
+// (or build with -DWDT_STATS=1)
+#ifndef WDT_STATS
+ #define WDT_STATS 0
+#endif
+#ifndef WDT_STATS_BUCKETS
+ #define WDT_STATS_BUCKETS 9 //# of buckets in the period error histogram; use an odd # so that one bucket is centered on 0
+#endif
+#ifndef WDT_STATS_BUCKET_MS
+ #define WDT_STATS_BUCKET_MS 4 //ms; width of each bucket
+#endif
+
+//Sampler (see beginSampler())
+//-off by default, since it defines the ADC ISR (ADC_vect); to turn it on, change the 0 below to a 1 (or build with -DWDT_SAMPLER=1)
+//-while it runs, the library owns the ADC: don't use analogRead() until stopSampler()
+#ifndef WDT_SAMPLER
+ #define WDT_SAMPLER 0
+#endif
+#define _WDT_SAMPLE_IDLE 0 //no sample being taken
+#define _WDT_SAMPLE_WAITING 1 //the ADC is on, & sleep() will start the conversion by going into SLEEP_MODE_ADC
+#define _WDT_SAMPLE_CONVERTING 2 //the conversion is running; ADC_vect ends it
+
+//Supervision mode (see beginSupervision())
+#define WDT_MAX_TASKS 8 //# of tasks which can be supervised; task #s are 0 to 7, & bit n of a task mask is task n
+
+//WDT calibration (see calibrate() & setBackgroundCalibration())
+#define WDT_CAL_EEPROM_SIZE sizeof(WDT_calibration_t) //bytes of EEPROM used by saveCalibration()
+#define _WDT_CAL_OFF 0 //never time the WDT delays while the timers run
+#define _WDT_CAL_EVERY 1 //time every WDT delay segment which runs while awake
+#define _WDT_CAL_AUTO 2 //default; time the first few of each WDT delay, then 1 in WDT_CAL_SAMPLE_EVERY of them
+#ifndef WDT_CAL_SEED_SAMPLES
+ #define WDT_CAL_SEED_SAMPLES 8 //# of segments of each WDT delay which _WDT_CAL_AUTO averages, before it only samples them
+#endif
+#ifndef WDT_CAL_SAMPLE_EVERY
+ #define WDT_CAL_SAMPLE_EVERY 64 //_WDT_CAL_AUTO times 1 in this many segments, once every delay has been seeded
+#endif
+
+//one software timer
+struct WDT_timer_t
+{
+	void (*func)(); //user function to call when this timer expires; NULL if this timer slot is free
+	uint32_t t_start; //ms; time stamp of the start of the current period
+	uint32_t t_deadline; //ms; time stamp at which func must be called, ideally; the next period is timed from it
+	uint32_t t_wake; //ms; time stamp at which func will be called: t_deadline, or the point within +/-t_slack of it which takes the fewest WDT wakeups
+	int32_t t_delay_desired; //ms; desired delay time (period)
+	unsigned int t_slack; //ms; how far from t_deadline func may be called, in order to save WDT wakeups; 0 for none; < t_delay_desired/2
+	byte mode; //_WDT_DO_ONCE or _WDT_REPEAT
+	byte heapIndex; //position of this timer in the deadline heap, or _WDT_NO_TIMER if it is not scheduled
+	byte overrunPolicy; //_WDT_OVERRUN_*
+	byte maxCatchUp; //_WDT_OVERRUN_CATCH_UP only: max # of missed periods to call back to back; the rest are skipped
+	byte behind; //# of its deadlines which had already passed at its last call
+	uint32_t missed; //# of periods whose deadline passed before the previous call was even made; ie: late ones
+	uint32_t coalesced; //# of those which were skipped (not called at all)
+};
+
+//one expired timer, queued by the ISR in deferred mode
+struct WDT_event_t
+{
+	byte timerID; //ID of the timer which expired; _WDT_LEGACY_TIMER for attachInterrupt(), or _WDT_CHAIN_TIMER for a WDTimer<PeriodMs>
+	uint32_t t_event; //ms; time stamp (in the now() time base) at which it expired
+	int32_t t_delay_actual; //ms; actual delay time, since the start of this period; ie: the same as _t_WDT_delay_actual, for any timer
+	void (*func)(); //its user function, which dispatch() calls
+};
+
+#if WDT_STATS
+//timing statistics of one timer, as returned by stats()
+struct WDT_stats_t
+{
+	byte timerID; //the timer these are for; see setStatsTimer()
+	uint32_t periods; //# of periods measured
+	int32_t t_period_min; //ms; shortest, longest & mean actual period
+	int32_t t_period_max;
+	float t_period_mean;
+	unsigned int errorHistogram[WDT_STATS_BUCKETS]; //# of periods by error (actual - desired period), in WDT_STATS_BUCKET_MS wide buckets; 
+	                                               //the middle one is centered on 0, & the first & last ones also count all of the errors beyond them
+	uint32_t wakeups; //total # of WDT interrupts during those periods (for all timers); ie: wakeups/periods per period
+	unsigned int wakeups_max; //most WDT interrupts during any one period
+	uint32_t t_func_max_us; //us; longest time the timer's user function took to run
+	uint32_t overruns; //# of times the user function took longer than the period itself (from the ISR: ran through its next deadline; see setStatsTimer())
+};
+#endif
+
+//the state of the attachInterrupt() timer (ID 0), as copied by snapshot()
+struct WDT_state_t
+{
+	uint32_t t_WDT_start; //ms; time stamp of the start of its current period
+	uint32_t t_WDT_end; //ms; time stamp of its last call
+	int32_t t_WDT_delay_desired; //ms; desired delay time (period)
+	int32_t t_WDT_delay_actual; //ms; actual delay time of its last period
+	int32_t t_WDT_delay_remaining; //ms; time left until the earliest deadline (of any timer), as of the last WDT interrupt
+	byte WDT_period; //WDTO_* delay running now (or _WDT_FINE_FINISH), for the earliest deadline
+	boolean WDT_mode; //_WDT_DO_ONCE or _WDT_REPEAT
+	byte userFuncCalls; //# of user function calls so far (by any timer), mod 256; if it changed between 2 snapshots, one was called in between
+};
+
+//calibration record, as stored in EEPROM by saveCalibration()
+struct WDT_calibration_t
+{
+	byte magic[2]; //'W','C'; marks a valid record
+	uint32_t segment_q8[10]; //1/256 ms; measured length of each WDTO_* delay
+	byte checksum; //sum of all of the bytes above
+};
+
 class eRCaGuy_WDTimer
 {
 	public:
@@ -104,42 +267,289 @@ class eRCaGuy_WDTimer
 		eRCaGuy_WDTimer(); //constructor
 		
 		//methods intended to be accessed by a user
-		boolean attachInterrupt(void (*isr)(),long t_desired_delay_ms,boolean mode=_WDT_DO_ONCE); //attach an interrupt function & execute this
+		boolean attachInterrupt(void (*isr)(),int32_t t_desired_delay_ms,boolean mode=_WDT_DO_ONCE,unsigned int t_slack_ms=0); //attach an interrupt function & execute this
 			                                                                                        //function after a specified time
-		boolean timedInterrupt(long t_desired_delay_ms,boolean mode=_WDT_DO_ONCE); //do a timed interrupt on the attached function
+		boolean timedInterrupt(int32_t t_desired_delay_ms,boolean mode=_WDT_DO_ONCE,unsigned int t_slack_ms=0); //do a timed interrupt on the attached function
 		void detachInterrupt(); //stop doing the timed interrupt function
 		void stop(); //same exact thing as detachInterrupt
+		byte addTimer(void (*func)(),int32_t t_desired_delay_ms,boolean mode=_WDT_DO_ONCE,unsigned int t_slack_ms=0); //start an additional, independent timer; returns its ID
+		byte atTime(void (*func)(),uint64_t t_ms,unsigned int t_slack_ms=0); //call func once, at now64() time t_ms; returns its timer ID, like addTimer()
+		byte everyAligned(void (*func)(),int32_t period_ms,int32_t phase_ms=0,unsigned int t_slack_ms=0); //call func whenever now64() % period_ms == phase_ms
+		boolean cancelTimer(byte timerID); //stop a timer started with addTimer(); returns false if it wasn't running
+		boolean setOverrunPolicy(byte timerID,byte policy,byte maxCatchUp=1); //what a _WDT_REPEAT timer does when it falls behind by whole periods
+		uint32_t missedPeriods(byte timerID); //# of periods of that timer which were late by a whole period or more, or whose deadline went by while the user functions held the WDT ISR off
+		uint32_t coalescedPeriods(byte timerID); //# of those which were skipped, rather than called late
+		boolean beginSupervision(byte taskMask,int32_t t_window_ms); //reset the mcu if any of these tasks doesn't checkIn() in a window
+		void stopSupervision();
+		void checkIn(byte task) { if (task<WDT_MAX_TASKS) _heartbeats[task] = 1; } //task (0 to WDT_MAX_TASKS-1) is alive; a single store, so it's safe anywhere, with no critical section; other task #s are ignored
+		byte stalledTasks(); //task mask of the tasks which stalled & caused the last supervision reset; 0 if none
+#if WDT_SAMPLER
+		byte beginSampler(byte channel,int32_t period_ms,unsigned int* buffer,byte batchSize,void (*batchHandler)()=NULL); //sample an ADC channel every period_ms, in batches; returns its timer ID
+		void stopSampler();
+		const unsigned int* readBatch(); //the batch which was last filled, or NULL if there is no new one since the last call
+		uint32_t batchOverruns(); //# of batches which were overwritten before readBatch() was called for them
+#endif
+		uint32_t sleep(); //sleep until the next time a user function gets called; returns the ms spent asleep
+		void setSleepMode(byte sleepMode,byte options=0); //ex: SLEEP_MODE_PWR_DOWN (the default), with options _WDT_SLEEP_ADC_OFF | _WDT_SLEEP_BOD_OFF
+		void setSleepHooks(void (*beforeSleep)(),void (*afterWake)()); //user functions to call right before & right after each sleep() call
+		uint32_t awakeTime(); //ms; time spent awake since the last resetDutyCycle()
+		uint32_t sleptTime(); //ms; time spent asleep in sleep() since the last resetDutyCycle()
+		float dutyCycle(); //%; awake time / total time, since the last resetDutyCycle()
+		void resetDutyCycle();
+		uint32_t now(); //ms; the time base all of the timers use, which keeps counting while asleep, unlike millis(); but not while the WDT ISR is held off
+		void syncMillis(); //add the time millis() missed while asleep back into millis()
+		void snapshot(WDT_state_t* state); //get a consistent copy of the attachInterrupt() timer's state, without turning interrupts off
+		uint64_t now64(); //ms; now(), extended to 64 bits (so it never rolls over), plus the offset set by setNow()
+		void setNow(uint64_t t_ms); //set now64() to t_ms, ex: to a shared time, so that everyAligned() timers on different nodes line up
+		boolean calibrate(byte maxPeriod=WDTO_1024MS,uint32_t (*reference_us)()=NULL); //measure the WDT delays against micros(), or reference_us()
+		float calibrationFactor(byte period); //actual/nominal length of a WDTO_* delay, as currently calibrated
+		void saveCalibration(int address); //store the calibration in EEPROM, at address to address+WDT_CAL_EEPROM_SIZE-1
+		boolean loadCalibration(int address); //restore it; returns false (& leaves the calibration as is) if there is no valid record there
+		void setBackgroundCalibration(byte mode,uint32_t (*reference_us)()=NULL); //_WDT_CAL_AUTO (the default), _WDT_CAL_EVERY or _WDT_CAL_OFF
+		void setDeferred(boolean deferred); //true to queue the user functions for dispatch() in loop(), rather than calling them in the ISR
+		boolean poll(WDT_event_t* event); //get the oldest event queued in deferred mode; returns false if there are none
+		byte dispatch(); //call the user function of every event queued in deferred mode (as of the call); returns the # called
+		uint32_t eventOverflows(); //# of events dropped so far because the queue was full
+#if WDT_STATS
+		void setStatsTimer(byte timerID); //the timer to keep statistics of; _WDT_LEGACY_TIMER (the default), an addTimer() ID, or _WDT_CHAIN_TIMER
+		void stats(WDT_stats_t* stats); //get a consistent copy of the statistics
+		void resetStats();
+#endif
 		
 		//methods intended to be accessed by an ISR (they are only public so that the ISR can have access to them too)
 		//I'm fairly new to C++, so the only other alternative I know, other than making these methods & members public, is to make them global.  I chose to make them public instead.
 		void WDT_begin();
 		void update_WDT_period();
+		void processTimers();
+		void stepChain();
+		void calibrationTick();
+#if WDT_SAMPLER
+		void sampleDone();
+#endif
+		
+		//methods intended to be accessed only by the WDTimer<PeriodMs> template, below
+		void beginChain(void (*func)(),const byte* chain,uint32_t numLongSegments,byte remainder_ms,uint32_t period_ms);
+		void stopChain();
 		
 		//public members (variables) - these must all be public so that they can be accessed by an ISR
 		void (*userFunc)(); //function pointer for the attachInterrupt method
 		
 		//volatile (used in ISRs)
-		volatile byte _userInterruptCalled; //flag to specify if the WDT time is elapsed yet; must be manually reset by the user
-		volatile unsigned long _t_WDT_start; //ms; time stamp of when the Watchdog Timer was turned on
-		volatile unsigned long _t_WDT_end; //ms; time stamp of when the WDT interrupt occurs
-		volatile long _t_WDT_delay_desired; //ms; desired delay time
-		volatile long _t_WDT_delay_actual; //ms; actual delay time, determined after each delay period
-		volatile long _t_WDT_delay_remaining; //ms; do NOT make unsigned, as it needs to be able to store neg. values the way my WDT ISR is written
-		volatile byte _WDT_period; //a byte to indicate what we will set the period to be before the next WDT interrupt occurs
-		volatile boolean _WDT_mode; //indicates if the delay and call to the user ISR should occur once or repeatedly, every specified delay (period)
+		volatile byte _userInterruptCalled; //flag to specify if the WDT time is elapsed yet (for any timer); must be manually reset by the user
+		volatile byte _stateGeneration; //incremented by the ISRs every time they may have changed the state which snapshot() copies
+		const byte* volatile _chain; //WDTimer<PeriodMs> constant table of WDTO_* periods, ending with _DESIRED_DELAY_TOO_SHORT; NULL when no chain is running
+		volatile boolean _calibrating; //true while calibrate() is running; the ISR then calls calibrationTick() instead of processTimers()
+		volatile byte _supervisorTimer; //ID of the timer which ends each supervision window; _WDT_NO_TIMER when not supervising
+#if WDT_SAMPLER
+		volatile byte _samplerTimer; //ID of the timer which starts each sample; _WDT_NO_TIMER when the sampler isn't running
+#endif
 	
   private:
 		//Private methods (ie: functions)
-		//NA
+		boolean startTimer(byte timerID,void (*func)(),int32_t t_desired_delay_ms,boolean mode,unsigned int t_slack_ms);
+		boolean startTimerAt(byte timerID,void (*func)(),uint32_t t_start,uint32_t t_deadline,int32_t t_period_ms,boolean mode,unsigned int t_slack_ms);
+		byte freeTimerSlot();
+		void planWake(WDT_timer_t* timer,uint32_t t_now);
+		void handleOverrun(WDT_timer_t* timer,uint32_t t_now,boolean heldOff);
+		uint32_t toUnits16(uint32_t t_ms,boolean roundUp);
+		uint32_t units16ToMs(uint32_t units16);
+		void unscheduleTimer(byte timerID);
+		void scheduleNextSegment(uint32_t t_now);
+		uint32_t timeNow();
+		uint64_t timeNow64();
+		void addToTimeBase(uint32_t t_ms);
+		uint32_t segmentLength_q8();
+		uint32_t segmentLength_q16();
+		void segmentDone();
+		boolean segmentOverdue();
+		void stopSegment();
+		void startIdle();
+		boolean deadlineBefore(byte heapIndex1,byte heapIndex2);
+		void heapSwap(byte heapIndex1,byte heapIndex2);
+		void heapSiftUp(byte heapIndex);
+		void heapSiftDown(byte heapIndex);
+		void heapInsert(byte timerID);
+		void heapRemove(byte heapIndex);
+		void restartChain();
+		byte nextChainSegment();
+#if WDT_FINE
+		boolean planFineFinish(uint32_t t_deadline,uint32_t t_now,boolean overdueOK);
+#endif
+		void pushEvent(byte timerID,void (*func)(),uint32_t t_event,int32_t t_delay_actual);
+		void callUserFunc(byte timerID,void (*func)());
+		void superviseWindow();
+#if WDT_SAMPLER
+		void startSample();
+		void stopSampling();
+#endif
+#if WDT_STATS
+		void statsPeriod(byte timerID,int32_t t_delay_actual,int32_t t_delay_desired,boolean heldOff);
+#endif
 		
 		//Private members (ie: variables)
-		//NA
+		//-these are only ever touched inside the WDT ISR, or by user methods with interrupts turned off
+		
+		//state of the attachInterrupt() timer; see snapshot()
+		//-the _t_WDT_start, _t_WDT_end, _t_WDT_delay_desired and _t_WDT_delay_actual values belong to the attachInterrupt() timer (ID 0);
+		// _t_WDT_delay_remaining and _WDT_period belong to whichever timer has the earliest deadline
+		volatile uint32_t _t_WDT_start; //ms; time stamp of when the Watchdog Timer was turned on
+		volatile uint32_t _t_WDT_end; //ms; time stamp of when the WDT interrupt occurs
+		volatile int32_t _t_WDT_delay_desired; //ms; desired delay time
+		volatile int32_t _t_WDT_delay_actual; //ms; actual delay time, determined after each delay period
+		volatile int32_t _t_WDT_delay_remaining; //ms; time left until the earliest deadline (of any timer), as of the last WDT interrupt; signed, since it is negative once that deadline has already passed
+		volatile byte _WDT_period; //a byte to indicate what we will set the period to be before the next WDT interrupt occurs
+		volatile boolean _WDT_mode; //indicates if the delay and call to the user ISR should occur once or repeatedly, every specified delay (period)
+		
+		WDT_timer_t _timers[WDT_MAX_TIMERS]; //the timer slots, indexed by timer ID
+		byte _heap[WDT_MAX_TIMERS]; //min-heap of timer IDs, ordered by deadline; _heap[0] is always the next timer to expire
+		byte _heapSize; //# of timers currently scheduled
+		
+		//sleep
+		byte _sleepMode; //SLEEP_MODE_*
+		byte _sleepOptions; //_WDT_SLEEP_* bits
+		void (*_beforeSleep)(); //user hooks; NULL if not used
+		void (*_afterWake)();
+		volatile byte _numUserFuncCalls; //incremented every time a user function is called; lets sleep() know when to return
+		volatile boolean _sleptThisSegment; //true if the mcu went to sleep during the WDT delay segment currently running
+		volatile uint32_t _t_millis_missed; //ms; time that millis() missed because Timer0 was stopped during sleep, not yet added back by syncMillis()
+		uint32_t _t_asleep; //ms; time spent asleep since _t_duty_start
+		uint32_t _t_duty_start; //ms; start of the duty cycle measurement
+		
+		//time base; see now()
+		volatile uint32_t _t_now; //ms; the time base, as of the end of the last WDT delay segment
+		volatile uint16_t _t_now_frac; //1/65536 ms; the fractional part of _t_now
+		volatile uint32_t _t_now_hi; //# of times _t_now has rolled over; ie: the upper 32 bits of the 64-bit time base
+		uint64_t _t_offset; //ms; added to the 64-bit time base by now64(); see setNow()
+		volatile boolean _segmentRunning; //true while a WDT delay segment is running
+		volatile uint32_t _t_anchor; //ms; a point in the time base, & what millis() was at that point; see timeNow()
+		volatile uint32_t _t_anchor_millis; //ms
+		boolean _heldOff; //true if the user functions were still running when the current segment ended; only for the next ISR; see processTimers()
+		uint32_t _t_segment_q8[10]; //1/256 ms; length of each WDTO_* delay; nominal until calibrated
+		byte _t_segment_frac[10]; //1/65536 ms; the next byte of it, which the time base counts too; see segmentLength_q16()
+#if WDT_FINE
+		uint32_t _t_fine_us; //us; desired length of the next Timer2 finish; see planFineFinish()
+		uint32_t _t_fine_q16; //1/65536 ms; actual length of the Timer2 finish which is running
+#endif
+		
+		//deferred mode; a single-producer (the ISR), single-consumer (poll()) ring buffer
+		boolean _deferred; //true to queue events, rather than calling the user functions in the ISR
+		WDT_event_t _events[WDT_EVENT_QUEUE_SIZE];
+		volatile byte _eventHead; //index of the next event to write; only the ISR writes it
+		volatile byte _eventTail; //index of the next event to read; only poll() writes it
+		volatile uint32_t _eventOverflows; //# of events dropped because the queue was full
+		
+#if WDT_STATS
+		//timing statistics; see stats()
+		byte _statsTimer; //ID of the timer to keep statistics of
+		WDT_stats_t _stats; //all but t_period_mean, which is computed from _t_stats_period_sum
+		uint64_t _t_stats_period_sum; //ms
+		unsigned int _statsWakeups; //# of WDT interrupts so far in the current period
+		boolean _statsHeldOff; //its user function, called from the ISR, ran past the end of the WDT delay which started before it
+#endif
+		
+		//calibration; see calibrate() & setBackgroundCalibration()
+		uint32_t (*_calReference)(); //us; the reference clock
+		byte _calPeriod; //WDTO_* delay being measured by calibrate()
+		volatile byte _calTicks; //# of WDT interrupts so far, for the delay being measured
+		volatile uint32_t _t_cal_first_us; //us; reference time of the first & last of those interrupts
+		volatile uint32_t _t_cal_last_us;
+		byte _calMode; //_WDT_CAL_*; see setBackgroundCalibration()
+		byte _calSamples[10]; //# of segments of each WDTO_* delay averaged into its length so far, up to WDT_CAL_SEED_SAMPLES
+		byte _calCountdown; //# of segments left until the next one is timed, once seeded
+		uint32_t (*_bgCalReference)(); //us; the reference clock for the background recalibration
+		boolean _bgCalSegment; //true if the current segment is being timed, for the background recalibration
+		uint32_t _t_segment_start_us; //us; reference time at the start of the current segment, if _bgCalSegment
+		
+		//supervision mode; see beginSupervision()
+		//-one flag byte per task, rather than one bit per task in a shared byte: setting a bit is a read-modify-write, which
+		// the ISR could clear the byte in the middle of (on an AVR), whereas storing a byte can't be interrupted
+		volatile byte _heartbeats[WDT_MAX_TASKS]; //non-zero if that task has checked in during the current window
+		byte _supervisedTasks; //task mask of the tasks being supervised
+		
+#if WDT_SAMPLER
+		//sampler; see beginSampler()
+		unsigned int* _sampleBuffer; //2 halves of _batchSize samples each; one is being filled while the other one is read
+		byte _batchSize;
+		byte _sampleChannel;
+		byte _sampleIndex; //index, within the half being filled, of the next sample
+		byte _sampleHalf; //half being filled (0 or 1)
+		volatile byte _sampleState; //_WDT_SAMPLE_*
+		volatile boolean _batchReady; //true if the other half is full, & hasn't been read by readBatch() yet
+		volatile boolean _inSleep; //true while sleep() is running, so the sample can be started by going to sleep
+		void (*_batchHandler)(); //user function to call every time a batch is full; NULL if not used
+		uint32_t _t_batch_start; //ms; time stamp of the first sample of the batch being filled
+		volatile uint32_t _batchOverruns;
+		byte _ADCSRA_user; //ADCSRA before beginSampler(), restored by stopSampler()
+#endif
+		
+		//fixed-period chain, started by a WDTimer<PeriodMs>; see stepChain()
+		void (*_chainFunc)(); //user function to call at the end of every period
+		uint32_t _chainNumLong; //# of WDTO_8192MS segments at the start of every period
+		uint32_t _chainLongLeft; //# of WDTO_8192MS segments left to do in the current period
+		byte _chainIndex; //index into _chain of the next segment to do, once _chainLongLeft is 0
+		byte _chainRemainder; //ms; period % 16; ie: the part of the period which the 16ms-multiple chain can't do
+		byte _chainRemainderSum; //ms; the remainder accumulated over the past periods, Bresenham style; see beginChain()
+		boolean _chainExtra; //true if the current period gets one extra WDTO_16MS segment at its end, to pay back the remainder
+		uint32_t _t_chain_start; //ms; start of the current period
+		uint32_t _chainPeriod; //ms; PeriodMs
 };
 
 //Declare the external existence (defined in the .cpp file) of an object of this class, so that you can access it in your Arduino sketch simply by including this library, via its header file
 //This is absolutely necessary or else the Arduino sketch that includes this library will not compile.
 //For more info on "extern" see here: http://www.geeksforgeeks.org/understanding-extern-keyword-in-c/
 extern eRCaGuy_WDTimer wdt;
+
+#if __cplusplus >= 201103L //needs C++11, ie: Arduino 1.6.6 or later
+//-------------------------------------------------------------------------------------------------------------------
+//WDTimer<PeriodMs>
+//-a front end for fixed periods, known at compile time; ex: "WDTimer<1000> everySecond;", then "everySecond.begin(myFunc);"
+//-the period is broken up into its chain of WDT delays at compile time: N x 8192ms, followed by the 4096ms to 16ms 
+// delays matching the set bits of (PeriodMs/16), largest first; this is exactly what update_WDT_period() would pick.
+// The ISR then just steps through that constant table with a single byte index, instead of doing millis() & 32-bit math
+// & the if ladder in update_WDT_period() on every WDT interrupt.
+//-the part of the period that isn't a multiple of 16ms (PeriodMs%16) is accumulated across periods, and paid back with 
+// one extra 16ms delay whenever it adds up to 16ms, so the long term average period is exact (w.r.t. the nominal WDT delays)
+//-since the chain is planned at compile time, calibrate() does NOT change it; the period is always made of the same WDT 
+// delays, so it is only as accurate as the WDT oscillator itself (now() still counts the calibrated lengths, though)
+//-the period must be at least 16ms, the shortest WDT delay; a shorter one won't compile, rather than quietly running at 16ms
+//-it's a _WDT_REPEAT timer which owns the WDT while it runs; it stops any timers started with the methods above, and 
+// they can't be started again until stop() is called
+//-------------------------------------------------------------------------------------------------------------------
+
+//the WDTO_* period of segment n (0 = first) of the chain made of the set bits (bit..0) of units16, largest first; 
+//_DESIRED_DELAY_TOO_SHORT once past the end of the chain
+constexpr byte WDT_chainSegment(unsigned int units16,byte n,int bit=WDTO_4096MS)
+{
+  return bit<0 ? _DESIRED_DELAY_TOO_SHORT :
+         !(units16 & (1U << bit)) ? WDT_chainSegment(units16,n,bit - 1) :
+         n==0 ? (byte)bit : WDT_chainSegment(units16,n - 1,bit - 1);
+}
+
+template <uint32_t PeriodMs>
+class WDTimer
+{
+	static_assert(PeriodMs >= 16, "WDTimer<PeriodMs>: the period must be at least 16ms, the shortest delay the WDT can do");
+	
+	public:
+		void begin(void (*func)()) { wdt.beginChain(func,_chain,UNITS16 >> 9,REMAINDER_MS,PeriodMs); } //start calling func every PeriodMs
+		void stop() { wdt.stopChain(); }
+		
+	private:
+		static const uint32_t UNITS16 = PeriodMs/16; //period, in 16ms units
+		static const byte REMAINDER_MS = PeriodMs%16; //ms
+		static const byte _chain[10];
+};
+
+template <uint32_t PeriodMs>
+const byte WDTimer<PeriodMs>::_chain[10] = 
+{
+	WDT_chainSegment(UNITS16 & 0x1FF,0), WDT_chainSegment(UNITS16 & 0x1FF,1), WDT_chainSegment(UNITS16 & 0x1FF,2),
+	WDT_chainSegment(UNITS16 & 0x1FF,3), WDT_chainSegment(UNITS16 & 0x1FF,4), WDT_chainSegment(UNITS16 & 0x1FF,5),
+	WDT_chainSegment(UNITS16 & 0x1FF,6), WDT_chainSegment(UNITS16 & 0x1FF,7), WDT_chainSegment(UNITS16 & 0x1FF,8),
+	_DESIRED_DELAY_TOO_SHORT //end of the chain
+};
+#endif //C++11
+
 #endif
 
 
@@ -0,0 +1,241 @@
+/*
+eRCaGuy_WDTimer_HAL
+-the thin Hardware Abstraction Layer (HAL) under the eRCaGuy_WDTimer library
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+/*
+-Every access the library makes to the Watchdog Timer hardware & to the Arduino time base goes through the functions below.
+-On an AVR they are simply inlined into the direct register accesses, so they cost nothing.
+-When compiled with WDT_HOST_SIM defined (see extras/host), they are instead implemented by a virtual-clock simulator, 
+ so that the library logic (the WDT ISR, update_WDT_period(), timedInterrupt(), etc.) can be run & benchmarked on a PC.
+-Critical sections still use SREG & noInterrupts() directly, just like any other Arduino code; the host build provides those too.
+*/
+
+#ifndef eRCaGuy_WDTimer_HAL_h
+#define eRCaGuy_WDTimer_HAL_h
+
+#if ARDUINO >= 100
+ #include <Arduino.h>
+#else
+ #include <WProgram.h>
+#endif
+
+//keeps the compiler from moving memory accesses across this point (ex: so that an event is fully written to a queue 
+//before the queue's volatile index says it's there); costs no instructions
+static inline void WDT_HAL_memoryBarrier()
+{
+  __asm__ __volatile__ ("" ::: "memory");
+}
+
+#ifdef WDT_HOST_SIM
+ #include "WDT_sim.h" //the simulator's versions of the functions below
+#else
+ #include <avr/wdt.h>
+ #include <avr/sleep.h>
+ #include <avr/eeprom.h>
+
+//start a new WDT delay segment, of the given WDTO_* period, in Interrupt Mode
+static inline void WDT_HAL_begin(byte period)
+{
+  wdt_enable(period); //enable the WD Timer (set WDE bit to 1 [Table 11-1 pg. 55 --> System Reset Mode]) & set the specified timeout period
+  wdt_reset(); //reset the timer to zero and let it start counting
+  WDTCSR |= _BV(WDIE); //set the WatchDog Interrupt Enable (WDIE) bit to 1, in order to ENABLE the WDT_vect interrupt!
+}
+
+//stop the WDT (ie: set the WDE bit to 0) in order to prevent the mcu from entering System Reset Mode; see datasheet Table 11-1 pg. 55
+static inline void WDT_HAL_disable()
+{
+  wdt_disable();
+  wdt_reset(); //reset elapsed Watchdog timer to zero
+}
+
+//clear the WatchDog Interrupt Enable (WDIE) bit to 0, in order to disable the WDT_vect interrupt
+static inline void WDT_HAL_disableInterrupt()
+{
+  WDTCSR &= ~_BV(WDIE);
+}
+
+//true if the WDT delay has already timed out, but WDT_vect hasn't run yet (ie: interrupts are off); the WatchDog Interrupt 
+//Flag (WDIF) stays set until the ISR runs
+static inline boolean WDT_HAL_interruptPending()
+{
+  return (WDTCSR & _BV(WDIF));
+}
+
+//start a new WDT delay, of the given WDTO_* period, in System Reset Mode only (no interrupt); ie: reset the mcu unless 
+//the WDT is restarted before then
+static inline void WDT_HAL_armReset(byte period)
+{
+  wdt_enable(period); //also clears WDIE
+  wdt_reset();
+}
+
+//reset the mcu with the WDT, as soon as possible (16ms); never returns
+static inline void WDT_HAL_systemReset()
+{
+  wdt_enable(WDTO_15MS);
+  for (;;) {}
+}
+
+//variables declared with this aren't cleared at startup, so they keep their value through a reset (but not a power cycle)
+#define WDT_HAL_NOINIT __attribute__((section(".noinit")))
+
+//ms; the Arduino time base (Timer0)
+static inline uint32_t WDT_HAL_millis()
+{
+  return millis();
+}
+
+//us; the default calibration reference (Timer0, ie: the crystal or resonator)
+static inline uint32_t WDT_HAL_micros()
+{
+  return micros();
+}
+
+//called over & over while busy-waiting for the WDT ISR (ex: in calibrate()); the ISR just interrupts it, so there is nothing to do
+static inline void WDT_HAL_busyWait()
+{
+}
+
+//add time to millis(), ex: time it missed while Timer0 was stopped; interrupts must be off
+//-timer0_millis is the millis() counter in the Arduino core's wiring.c; NOTE: micros() is not affected
+extern "C" volatile uint32_t timer0_millis;
+static inline void WDT_HAL_addToMillis(uint32_t t_ms)
+{
+  timer0_millis += t_ms;
+}
+
+//go to sleep until any interrupt occurs
+//-must be called with interrupts OFF, right after checking that there is still a reason to sleep, so that an interrupt can't 
+// sneak in between that check & going to sleep; interrupts are back on when this returns
+//-see the example in the AVRLibc sleep.h documentation: http://www.nongnu.org/avr-libc/user-manual/group__avr__sleep.html
+static inline void WDT_HAL_sleep(byte sleepMode,boolean disableBOD)
+{
+  set_sleep_mode(sleepMode);
+  sleep_enable();
+ #ifdef sleep_bod_disable
+  if (disableBOD)
+    sleep_bod_disable(); //must be done right before sleep_cpu()
+ #else
+  (void)disableBOD; //this mcu can't turn its BOD off in software
+ #endif
+  interrupts(); //the instruction right after "sei" always executes before any pending interrupt, so we are guaranteed to go to sleep
+  sleep_cpu();
+  sleep_disable();
+}
+
+//Timer2, for the fine mode's short finish (see WDT_FINE in eRCaGuy_WDTimer.h)
+//-CTC mode, with the /1024 prescaler, so 1 tick = 64us on a 16MHz Arduino, & the longest finish is 255 ticks (16.3ms)
+//-Timer2 only counts while awake or in SLEEP_MODE_IDLE (in sync. mode, the other sleep modes stop its clock)
+#define WDT_HAL_FINE_RESOLUTION_US (1024UL/(F_CPU/1000000UL)) //us; length of 1 Timer2 tick, rounded down
+
+//start a one-shot Timer2 compare match interrupt (TIMER2_COMPA_vect) t_us from now (as close as the tick length allows, 
+//& at most 255 ticks); returns the actual time, in us, until it fires
+static inline uint32_t WDT_HAL_fineBegin(uint32_t t_us)
+{
+  uint32_t ticks = (t_us*(F_CPU/1000000UL) + 512)/1024; //rounded to the nearest tick
+  if (ticks < 1)
+    ticks = 1;
+  else if (ticks > 255)
+    ticks = 255;
+  TCCR2B = 0; //stop Timer2
+  TCCR2A = _BV(WGM21); //CTC mode: count from 0 up to OCR2A
+  TCNT2 = 0;
+  OCR2A = ticks - 1;
+  TIFR2 = _BV(OCF2A); //clear any old compare match
+  TIMSK2 = _BV(OCIE2A); //enable the compare match A interrupt
+  TCCR2B = _BV(CS22) | _BV(CS21) | _BV(CS20); //start counting, at F_CPU/1024
+  return ticks*1024/(F_CPU/1000000UL);
+}
+
+//true if the compare match has already happened, but TIMER2_COMPA_vect hasn't run yet
+static inline boolean WDT_HAL_finePending()
+{
+  return (TIFR2 & _BV(OCF2A));
+}
+
+static inline void WDT_HAL_fineStop()
+{
+  TCCR2B = 0; //stop Timer2
+  TIMSK2 &= ~_BV(OCIE2A);
+}
+
+//EEPROM block read & write; eeprom_update_block() only writes the bytes which changed, to save EEPROM wear
+static inline void WDT_HAL_eepromRead(int address,void* data,size_t size)
+{
+  eeprom_read_block(data,(const void*)address,size);
+}
+
+static inline void WDT_HAL_eepromWrite(int address,const void* data,size_t size)
+{
+  eeprom_update_block(data,(void*)address,size);
+}
+
+//turn the ADC off; returns the old ADCSRA value, to be passed to WDT_HAL_adcRestore()
+static inline byte WDT_HAL_adcOff()
+{
+  byte ADCSRA_old = ADCSRA;
+  ADCSRA &= ~_BV(ADEN);
+  return ADCSRA_old;
+}
+
+static inline void WDT_HAL_adcRestore(byte ADCSRA_old)
+{
+  ADCSRA = ADCSRA_old;
+}
+
+//one ADC sample, for the sampler (see WDT_SAMPLER in eRCaGuy_WDTimer.h)
+//-turn the ADC on, with its interrupt (ADC_vect), reading channel (0-15, as in the MUX bits) against AVcc, at F_CPU/128
+// (125kHz at 16MHz); the conversion is then started either by WDT_HAL_adcStartConversion(), or by going to sleep in
+// SLEEP_MODE_ADC; the first one after turning the ADC on takes 25 ADC clocks (200us at 125kHz)
+static inline void WDT_HAL_adcSampleBegin(byte channel)
+{
+  ADMUX = _BV(REFS0) | (channel & 0x0F);
+  ADCSRA = _BV(ADEN) | _BV(ADIF) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0); //writing ADIF clears any old one
+}
+
+static inline void WDT_HAL_adcStartConversion()
+{
+  ADCSRA |= _BV(ADSC);
+}
+
+//read the result (from ADC_vect), & turn the ADC back off, so it draws nothing until the next sample
+static inline unsigned int WDT_HAL_adcSampleEnd()
+{
+  unsigned int value = ADC;
+  ADCSRA = 0;
+  return value;
+}
+#endif //WDT_HOST_SIM
+
+#endif
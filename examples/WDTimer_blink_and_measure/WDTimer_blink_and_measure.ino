@@ -52,7 +52,7 @@ Written 5 Aug. 2014
 //--------------------------------------------------------------------------------------------------
 boolean attachInterrupt(userFunction,long t_desired_delay_ms, boolean mode [default is _WDT_DO_ONCE])
 -attach an interrupt function & execute this function after a specified time, according to the mode
--returns a boolean to tell you whether or not the delay time is valid; ie: any delay time <8ms is always too short
+-returns a boolean to tell you whether or not the delay time is valid; ie: any delay time <8ms is always too short (<1ms in fine mode, WDT_FINE 1)
 -Modes: _WDT_DO_ONCE will interrupt your code & execute the interrupt function one time after the specified time, then it disables the timer & interrupt
         _WDT_REPEAT will repeatedly call the interrupt function at the specified time interval, until you call wdt.detachInterrupt() or wdt.stop().
 
@@ -71,12 +71,11 @@ void stop()
 //--------------------------------------------------------------------------------------------------
 //volatile (used in ISR)
 volatile byte _userInterruptCalled; //flag to specify if the WDT time is elapsed yet; must be manually reset by the user
-volatile unsigned long _t_WDT_start; //ms; time stamp of when the Watchdog Timer was turned on
-volatile unsigned long _t_WDT_end; //ms; time stamp of when the WDT interrupt occurs
-volatile long _t_WDT_delay_desired; //ms; desired delay time
-volatile long _t_WDT_delay_actual; //ms; actual delay time, determined after each delay period
-volatile long _t_WDT_delay_remaining; //ms; remaining delay time until the next user interrupt is called
-volatile boolean _WDT_mode; //indicates if the delay and call to the user ISR should occur once or repeatedly, every specified delay (period)
+
+//the rest of the timer's state (the start & end time stamps, the desired & actual delay times, the mode, etc) is copied
+//by snapshot(), which never turns interrupts off:
+void snapshot(WDT_state_t* state)
+-ex: "WDT_state_t state; wdt.snapshot(&state); long dt_actual = state.t_WDT_delay_actual;"
 */
 
 #include <eRCaGuy_WDTimer.h>
@@ -124,8 +123,10 @@ void loop()
     
     wdt._userInterruptCalled = false; //reset flag; this flag must be manually reset by the user
     
+    WDT_state_t state;
+    wdt.snapshot(&state); //a consistent copy of the timer's state, with no need to turn interrupts off
+    long dt_actual = state.t_WDT_delay_actual; //ms
     noInterrupts(); //prepare to read a multi-byte volatile variable
-    long dt_actual = wdt._t_WDT_delay_actual; //ms
     unsigned long counter_cpy = counter; //copy out the volatile value
     interrupts();
     Serial.print(counter_cpy); Serial.print(F(",")); Serial.print(dt_des); Serial.print(F(",")); Serial.println(dt_actual);
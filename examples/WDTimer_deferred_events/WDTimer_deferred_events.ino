@@ -0,0 +1,114 @@
+/*
+Examples for library: eRCaGuy_WDTimer
+-A library that uses the Watchdog Timer to interrupt your code and call an event every ___ms, either once per command, or repeatedly.
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
+Copyright (C) 2014 Gabriel Staples.  All right reserved.
+*/
+
+/*
+Example Code:
+WDTimer_deferred_events
+-runs the same kind of timers as the WDTimer_multiple_timers example, but in deferred mode: the WDT ISR only queues an
+ event for each expired timer, and loop() calls the user functions, with interrupts on, so they can safely use Serial,
+ take their time, etc, without holding off any other interrupts
+-loop() is purposely slow (a 700ms delay), to show that no events are lost; they just wait in the queue
+-make sure to open your Serial Monitor after uploading the code
+Written 16 Oct. 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+
+/*
+//--------------------------------------------------------------------------------------------------
+//PUBLIC METHODS USED BELOW (see the WDTimer_basic_blink_on_interrupt & WDTimer_multiple_timers examples for the rest)
+//--------------------------------------------------------------------------------------------------
+void setDeferred(boolean deferred)
+-true to have the ISR queue an event for each expired timer, rather than calling its user function right away
+
+byte dispatch()
+-call the user function of every event queued so far; returns the # of them called
+
+boolean poll(WDT_event_t* event)
+-get the oldest queued event (its timerID, t_event, t_delay_actual & func), without calling its user function; returns 
+ false if there are none
+
+unsigned long eventOverflows()
+-# of events dropped so far because the queue was full (WDT_EVENT_QUEUE_SIZE-1 events can wait in it)
+*/
+
+#include <eRCaGuy_WDTimer.h>
+
+const byte led = 13;
+byte secondsTimer; //ID of the 1000ms timer
+unsigned long seconds = 0; //no need for volatile, since the user functions are no longer called from the ISR
+
+void setup()
+{
+  pinMode(led,OUTPUT);
+  Serial.begin(115200);
+  Serial.println(F("\nbegin\n"));
+  
+  wdt.setDeferred(true);
+  wdt.attachInterrupt(blinkLED,250,_WDT_REPEAT); //timer 0
+  secondsTimer = wdt.addTimer(countSeconds,1000,_WDT_REPEAT);
+}
+
+void loop()
+{
+  delay(700); //some slow task
+  
+  //wdt.dispatch() would simply call each event's user function; poll() lets us look at the events first
+  WDT_event_t event;
+  while (wdt.poll(&event))
+  {
+    if (event.timerID==secondsTimer)
+    {
+      Serial.print(F("t = ")); Serial.print(event.t_event);
+      Serial.print(F("ms, after ")); Serial.print(event.t_delay_actual); Serial.print(F("ms: "));
+    }
+    event.func();
+  }
+  
+  if (wdt.eventOverflows()>0)
+    Serial.println(F("events were dropped!"));
+}
+
+void blinkLED()
+{
+  static boolean led_state = LOW;
+  led_state = !led_state; //toggle
+  digitalWrite(led,led_state);
+}
+
+void countSeconds()
+{
+  seconds++;
+  Serial.print(F("seconds = ")); Serial.println(seconds); //OK, since this is called from loop(), not from the ISR
+}
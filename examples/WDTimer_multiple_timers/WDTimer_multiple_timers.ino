@@ -0,0 +1,115 @@
+/*
+Examples for library: eRCaGuy_WDTimer
+-A library that uses the Watchdog Timer to interrupt your code and call an event every ___ms, either once per command, or repeatedly.
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
+Copyright (C) 2014 Gabriel Staples.  All right reserved.
+*/
+
+/*
+Example Code:
+WDTimer_multiple_timers
+-runs three independent timers at once, all on the one Watchdog Timer: LED 13 blinks every 250ms, a counter is printed
+ every 1000ms, and a one-time message is printed 5 seconds after startup
+-make sure to open your Serial Monitor after uploading the code
+Written 16 Oct. 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+
+/*
+//--------------------------------------------------------------------------------------------------
+//PUBLIC METHODS USED BELOW (see the WDTimer_basic_blink_on_interrupt example for the rest)
+//--------------------------------------------------------------------------------------------------
+byte addTimer(userFunction,long t_desired_delay_ms, boolean mode [default is _WDT_DO_ONCE])
+-start an additional timer, which runs independently of the attachInterrupt() timer and of all other timers
+-returns the timer's ID, or _WDT_NO_TIMER if the delay time is too short (<8ms, or <1ms in fine mode) or all WDT_MAX_TIMERS timers are in use
+
+boolean cancelTimer(byte timerID)
+-stop a timer started with addTimer()
+*/
+
+#include <eRCaGuy_WDTimer.h>
+
+const byte led = 13;
+volatile unsigned long seconds = 0;
+volatile boolean printNow = false;
+volatile boolean fiveSecondsElapsed = false;
+byte secondsTimer; //ID of the 1000ms timer
+
+void setup()
+{
+  pinMode(led,OUTPUT);
+  Serial.begin(115200);
+  Serial.println(F("\nbegin\n"));
+  
+  wdt.attachInterrupt(blinkLED,250,_WDT_REPEAT); //timer 0
+  secondsTimer = wdt.addTimer(countSeconds,1000,_WDT_REPEAT);
+  wdt.addTimer(fiveSecondsOver,5000); //_WDT_DO_ONCE
+}
+
+void loop()
+{
+  if (printNow)
+  {
+    printNow = false;
+    noInterrupts(); //prepare to read a multi-byte volatile variable
+    unsigned long seconds_cpy = seconds;
+    interrupts();
+    Serial.print(F("seconds = ")); Serial.println(seconds_cpy);
+    if (seconds_cpy==20)
+    {
+      wdt.cancelTimer(secondsTimer);
+      Serial.println(F("stopped counting; the LED keeps blinking"));
+    }
+  }
+  if (fiveSecondsElapsed)
+  {
+    fiveSecondsElapsed = false;
+    Serial.println(F("5 seconds are up"));
+  }
+}
+
+void blinkLED()
+{
+  static boolean led_state = LOW;
+  led_state = !led_state; //toggle
+  digitalWrite(led,led_state);
+}
+
+void countSeconds()
+{
+  seconds++;
+  printNow = true;
+}
+
+void fiveSecondsOver()
+{
+  fiveSecondsElapsed = true;
+}
@@ -0,0 +1,107 @@
+/*
+Examples for library: eRCaGuy_WDTimer
+-A library that uses the Watchdog Timer to interrupt your code and call an event every ___ms, either once per command, or repeatedly.
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
+Copyright (C) 2014 Gabriel Staples.  All right reserved.
+*/
+
+/*
+Example Code:
+WDTimer_sampler
+-low-power data logging: samples A0 every 100ms, while the mcu sleeps in power-down mode in between, & only wakes 
+ loop() up once a second, with a batch of 10 samples, whose min, mean & max it prints
+-each sample is taken in ADC noise reduction sleep (SLEEP_MODE_ADC), so the mcu is only awake for a few us per sample
+-NOTE: the sampler must be compiled into the library: change "#define WDT_SAMPLER 0" to 1 in eRCaGuy_WDTimer.h
+-make sure to open your Serial Monitor after uploading the code
+Written 16 Oct. 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+
+
+/*
+//--------------------------------------------------------------------------------------------------
+//PUBLIC METHODS USED BELOW (see the WDTimer_basic_blink_on_interrupt & WDTimer_sleep_between_blinks examples for the rest)
+//--------------------------------------------------------------------------------------------------
+byte beginSampler(byte channel,long period_ms,unsigned int* buffer,byte batchSize,void (*batchHandler)()=NULL)
+-take one ADC sample of channel (ex: 0 for A0) every period_ms, into buffer, which must hold 2*batchSize samples; every 
+ time batchSize samples are in, sleep() returns (& batchHandler() is called, if given).  Takes one addTimer() slot.
+ Returns its timer ID, or _WDT_NO_TIMER if it couldn't be started.
+
+const unsigned int* readBatch()
+-the last full batch, oldest sample first, or NULL if there is no new one; read it before the next one is full
+
+unsigned long batchOverruns()
+-# of batches which were overwritten before being read
+
+void stopSampler()
+-stop sampling; the ADC is put back the way it was, so analogRead() can be used again
+*/
+
+#include <eRCaGuy_WDTimer.h>
+
+#if !WDT_SAMPLER
+ #error "change \"#define WDT_SAMPLER 0\" to 1 in eRCaGuy_WDTimer.h to use the sampler"
+#endif
+
+const byte BATCH_SIZE = 10;
+unsigned int samples[2*BATCH_SIZE]; //one half is filled while the other one is read
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println(F("\nbegin\n"));
+  
+  wdt.setSleepMode(SLEEP_MODE_PWR_DOWN);
+  wdt.beginSampler(0,100,samples,BATCH_SIZE); //A0, every 100ms, 10 at a time
+}
+
+void loop()
+{
+  Serial.flush(); //finish sending before going to sleep
+  wdt.sleep(); //returns once per batch
+  
+  const unsigned int* batch = wdt.readBatch();
+  if (batch==NULL)
+    return;
+  unsigned int sampleMin = 1023;
+  unsigned int sampleMax = 0;
+  unsigned long sum = 0;
+  for (byte i=0; i<BATCH_SIZE; i++)
+  {
+    sampleMin = min(sampleMin,batch[i]);
+    sampleMax = max(sampleMax,batch[i]);
+    sum += batch[i];
+  }
+  Serial.print(F("A0: min = ")); Serial.print(sampleMin);
+  Serial.print(F(", mean = ")); Serial.print((float)sum/BATCH_SIZE);
+  Serial.print(F(", max = ")); Serial.print(sampleMax);
+  Serial.print(F(", overruns = ")); Serial.println(wdt.batchOverruns());
+}
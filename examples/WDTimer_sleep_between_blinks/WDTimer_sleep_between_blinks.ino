@@ -0,0 +1,99 @@
+/*
+Examples for library: eRCaGuy_WDTimer
+-A library that uses the Watchdog Timer to interrupt your code and call an event every ___ms, either once per command, or repeatedly.
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
+Copyright (C) 2014 Gabriel Staples.  All right reserved.
+*/
+
+/*
+Example Code:
+WDTimer_sleep_between_blinks
+-blinks LED 13 once every 2 seconds, sleeping in power-down mode the rest of the time, and prints the % of time the mcu
+ was awake (its duty cycle) every 10 blinks
+-make sure to open your Serial Monitor after uploading the code
+Written 16 Oct. 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+/*
+//--------------------------------------------------------------------------------------------------
+//PUBLIC METHODS USED BELOW (see the WDTimer_basic_blink_on_interrupt example for the rest)
+//--------------------------------------------------------------------------------------------------
+void setSleepMode(byte sleepMode, byte options [default is 0])
+-sleepMode is any of the SLEEP_MODE_* values from <avr/sleep.h>; SLEEP_MODE_PWR_DOWN is the default
+-options can be _WDT_SLEEP_ADC_OFF and/or _WDT_SLEEP_BOD_OFF, to turn the ADC and/or Brown-Out Detector off while asleep
+
+void sleep()
+-sleeps until the next time one of your attached functions gets called; it only wakes up briefly (inside the WDT ISR)
+ in between
+
+float dutyCycle()
+-the % of time the mcu was awake since the last resetDutyCycle()
+*/
+
+#include <eRCaGuy_WDTimer.h>
+
+const byte led = 13;
+volatile unsigned int blinks = 0;
+
+void setup()
+{
+  pinMode(led,OUTPUT);
+  Serial.begin(115200);
+  Serial.println(F("\nbegin\n"));
+  Serial.flush(); //finish sending before going to sleep
+  
+  wdt.setSleepMode(SLEEP_MODE_PWR_DOWN,_WDT_SLEEP_ADC_OFF | _WDT_SLEEP_BOD_OFF);
+  wdt.attachInterrupt(blinkLED,2000,_WDT_REPEAT);
+  wdt.resetDutyCycle();
+}
+
+void loop()
+{
+  wdt.sleep(); //zzz...until blinkLED() gets called
+  
+  noInterrupts(); //prepare to read a multi-byte volatile variable
+  unsigned int blinks_cpy = blinks;
+  interrupts();
+  if (blinks_cpy%10==0)
+  {
+    Serial.print(F("blinks = ")); Serial.print(blinks_cpy);
+    Serial.print(F(", awake duty cycle = ")); Serial.print(wdt.dutyCycle(),4); Serial.println(F("%"));
+    Serial.flush(); //finish sending before going back to sleep
+  }
+}
+
+void blinkLED()
+{
+  blinks++;
+  digitalWrite(led,HIGH);
+  delayMicroseconds(1000); //a short flash; delay() can't be used inside an ISR
+  digitalWrite(led,LOW);
+}
@@ -0,0 +1,126 @@
+/*
+Examples for library: eRCaGuy_WDTimer
+-A library that uses the Watchdog Timer to interrupt your code and call an event every ___ms, either once per command, or repeatedly.
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Contact Info: http://electricrcaircraftguy.blogspot.com/2013/01/contact-me.html
+Copyright (C) 2014 Gabriel Staples.  All right reserved.
+*/
+
+/*
+Example Code:
+WDTimer_supervision
+-uses the Watchdog Timer as a real watchdog again (supervision mode), while still using it to blink an LED
+-loop() runs 2 tasks: one reads the Serial port, the other prints a count every second; each one calls wdt.checkIn() 
+ every time it runs.  If either one stops running for a whole 2 second supervision window (send a 'h' to hang the 
+ printing task, ex: like a stuck sensor read), the mcu is reset, & setup() then prints which task stalled.
+-make sure to open your Serial Monitor after uploading the code
+-NOTE: this needs a bootloader which turns the WDT off after a WDT reset, like Optiboot (Arduino Uno); otherwise the 
+ mcu keeps resetting
+Written 16 Oct. 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+
+/*
+//--------------------------------------------------------------------------------------------------
+//PUBLIC METHODS USED BELOW (see the WDTimer_basic_blink_on_interrupt & WDTimer_multiple_timers examples for the rest)
+//--------------------------------------------------------------------------------------------------
+boolean beginSupervision(byte taskMask,long t_window_ms)
+-turn supervision mode on: every task in taskMask (bit n = task n, 0 to 7) must call checkIn(n) at least once every 
+ t_window_ms, or the mcu is reset; the timers keep working.  Takes one addTimer() slot.  Keep the timers' user 
+ functions short (a few ms), since one which holds the WDT interrupt off for 2 WDT delays in a row resets the mcu too;
+ or call them from loop(), with setDeferred().
+
+void checkIn(byte task)
+-task is alive; a single store, so it's cheap enough to call on every pass through loop()
+
+byte stalledTasks()
+-the task mask of the tasks which caused the last supervision mode reset; 0 if none.  Call it before beginSupervision(), 
+ which clears it.
+
+void stopSupervision()
+-turn supervision mode off again
+*/
+
+#include <eRCaGuy_WDTimer.h>
+
+//task #s
+const byte SERIAL_TASK = 0;
+const byte PRINT_TASK = 1;
+
+const byte led = 13;
+boolean hang = false;
+
+void setup()
+{
+  pinMode(led,OUTPUT);
+  Serial.begin(115200);
+  Serial.println(F("\nbegin\n"));
+  
+  byte stalled = wdt.stalledTasks();
+  if (stalled!=0)
+  {
+    Serial.print(F("reset by supervision mode; stalled tasks: 0x")); Serial.println(stalled,HEX);
+  }
+  
+  wdt.attachInterrupt(blinkLED,250,_WDT_REPEAT);
+  wdt.beginSupervision(_BV(SERIAL_TASK) | _BV(PRINT_TASK),2000);
+  Serial.println(F("send 'h' to hang the printing task"));
+}
+
+void loop()
+{
+  //task 0: read the Serial port
+  if (Serial.available() && Serial.read()=='h')
+    hang = true;
+  wdt.checkIn(SERIAL_TASK);
+  
+  //task 1: print a count every second
+  static unsigned long t_last = 0;
+  static unsigned long count = 0;
+  if (millis() - t_last >= 1000)
+  {
+    t_last += 1000;
+    count++;
+    Serial.print(F("count = ")); Serial.println(count);
+    if (hang)
+    {
+      Serial.println(F("hanging..."));
+      while (true) {} //stuck; interrupts are still on, so the LED keeps blinking, but the reset comes anyway
+    }
+  }
+  wdt.checkIn(PRINT_TASK);
+}
+
+void blinkLED()
+{
+  static boolean led_state = LOW;
+  led_state = !led_state; //toggle
+  digitalWrite(led,led_state);
+}
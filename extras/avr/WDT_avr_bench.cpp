@@ -0,0 +1,129 @@
+/*
+WDT_avr_bench
+-the AVR (ATmega328P) benchmark firmware of the eRCaGuy_WDTimer library, run cycle by cycle under simavr by WDT_simavr
+-it runs the scenarios listed in WDT_avr_bench.h, in order, & marks what it's doing by writing to GPIOR0; all of the 
+ measuring is done by the runner, so the firmware itself is barely disturbed by it (one "out" instruction per marker)
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "eRCaGuy_WDTimer.h"
+#include "WDT_avr_bench.h"
+
+static const long delays[BENCH_NUM_DELAYS] = BENCH_DELAYS_MS;
+static const long periods[BENCH_NUM_PERIODS] = BENCH_PERIODS_MS;
+static const byte periodCalls[BENCH_NUM_PERIODS] = BENCH_PERIOD_CALLS;
+
+static volatile byte calls; //# of userFunc() calls so far, in the current scenario
+
+static inline void mark(byte marker)
+{
+  GPIOR0 = marker;
+}
+
+static void beginScenario(byte scenario)
+{
+  GPIOR1 = scenario;
+  mark(MARK_SCENARIO);
+}
+
+void userFunc()
+{
+  mark(MARK_USER_FUNC); //first thing, for the latency
+  calls++;
+}
+
+static void backgroundFunc()
+{
+}
+
+//sleep until userFunc() has been called n times; in SLEEP_MODE_IDLE, so that millis() keeps counting, & so that simavr 
+//can skip ahead to the next interrupt, rather than run a busy loop instruction by instruction
+static void waitForCalls(byte n)
+{
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  while (calls < n)
+    sleep_mode();
+}
+
+void setup()
+{
+  //the cost of the markers themselves, which the runner subtracts from every call
+  beginScenario(SCENARIO_CALIBRATE);
+  mark(MARK_CALL_BEGIN);
+  mark(MARK_CALL_END);
+  
+  //timedInterrupt(), with no timer running, so it starts the WDT too
+  wdt.attachInterrupt(userFunc,1000); //just to attach userFunc()
+  wdt.stop();
+  for (byte i=0; i<BENCH_NUM_DELAYS; i++)
+  {
+    beginScenario(SCENARIO_TIMED_START + i);
+    mark(MARK_CALL_BEGIN);
+    wdt.timedInterrupt(delays[i]);
+    mark(MARK_CALL_END);
+    wdt.stop();
+  }
+  
+  //timedInterrupt() again, restarting the attachInterrupt() timer while it & another timer are running
+  byte backgroundTimer = wdt.addTimer(backgroundFunc,5000,_WDT_REPEAT);
+  wdt.timedInterrupt(1000,_WDT_REPEAT);
+  for (byte i=0; i<BENCH_NUM_DELAYS; i++)
+  {
+    beginScenario(SCENARIO_TIMED_RESTART + i);
+    mark(MARK_CALL_BEGIN);
+    wdt.timedInterrupt(delays[i],_WDT_REPEAT);
+    mark(MARK_CALL_END);
+  }
+  wdt.stop();
+  wdt.cancelTimer(backgroundTimer);
+  
+  //the WDT ISR, & the latency from the WDT interrupt flag to userFunc(), for a _WDT_REPEAT timer on its own
+  for (byte i=0; i<BENCH_NUM_PERIODS; i++)
+  {
+    beginScenario(SCENARIO_REPEAT + i);
+    calls = 0;
+    wdt.attachInterrupt(userFunc,periods[i],_WDT_REPEAT);
+    waitForCalls(periodCalls[i]);
+    wdt.stop();
+  }
+  
+  //sleeping with interrupts off ends the simulation
+  mark(MARK_DONE);
+  cli();
+  sleep_enable();
+  sleep_cpu();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,60 @@
+/*
+WDT_avr_bench
+-the protocol between the AVR benchmark firmware (WDT_avr_bench.cpp) & its simavr runner (WDT_simavr.c): the markers 
+ the firmware writes to GPIOR0, & the scenarios it runs, in order
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+#ifndef WDT_avr_bench_h
+#define WDT_avr_bench_h
+
+//markers; each one is a single write to GPIOR0, which the runner sees with the exact cycle # it happened at
+#define MARK_SCENARIO 1 //a new scenario starts; its # is in GPIOR1
+#define MARK_CALL_BEGIN 2 //right before the call being measured...
+#define MARK_CALL_END 3 //...& right after it
+#define MARK_USER_FUNC 4 //first thing in the user function
+#define MARK_DONE 5 //all scenarios done
+
+//scenario settings
+#define BENCH_NUM_DELAYS 4
+#define BENCH_DELAYS_MS {16, 100, 1000, 30000} //ms; timedInterrupt() delays
+#define BENCH_NUM_PERIODS 4
+#define BENCH_PERIODS_MS {16, 100, 1000, 2500} //ms; _WDT_REPEAT periods
+#define BENCH_PERIOD_CALLS {64, 32, 8, 4} //# of user function calls to run each of them for
+
+//scenarios (the # in GPIOR1)
+#define SCENARIO_CALIBRATE 0 //an empty MARK_CALL_BEGIN/MARK_CALL_END pair; ie: the cost of the markers themselves
+#define SCENARIO_TIMED_START 1 //+ delay index: timedInterrupt(), with no timer running
+#define SCENARIO_TIMED_RESTART (SCENARIO_TIMED_START + BENCH_NUM_DELAYS) //+ delay index: timedInterrupt() again, while it & another timer are running
+#define SCENARIO_REPEAT (SCENARIO_TIMED_RESTART + BENCH_NUM_DELAYS) //+ period index: a _WDT_REPEAT timer, for the WDT ISR & the user function latency
+#define NUM_SCENARIOS (SCENARIO_REPEAT + BENCH_NUM_PERIODS)
+
+#endif
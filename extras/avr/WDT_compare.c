@@ -0,0 +1,181 @@
+/*
+WDT_compare
+-compares the results of the AVR benchmark (as written by WDT_simavr -o) against a baseline, & fails if anything got worse
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+/*
+Usage: WDT_compare [-tolerance <%>] baseline.txt results.txt
+  -tolerance <%>   how much worse than the baseline a metric may get (default 2); lower is better for all of them
+Exit status:
+  0  every metric is within the tolerance of the baseline
+  1  at least one metric got worse by more than the tolerance, or is in only one of the 2 files
+  2  no comparison could be made: a file can't be read, the baseline has no results (ex: it was never recorded), or it
+     was recorded with different library options; so an empty or stale baseline never passes
+-it only needs a C compiler (no avr-gcc or simavr), so the gate itself can be checked anywhere; see "make test-compare"
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_METRICS 64
+
+struct metric_t
+{
+  char name[48];
+  double value;
+};
+
+struct results_t
+{
+  char options[256]; //the library options the firmware was built with
+  struct metric_t metrics[MAX_METRICS];
+  int num_metrics;
+};
+
+static struct results_t baseline;
+static struct results_t results;
+
+//reads a results file written by WDT_simavr -o; returns 0 if it can't be opened
+static int readResults(const char* fileName,struct results_t* r)
+{
+  char line[256];
+  FILE* f = fopen(fileName,"r");
+  if (f==NULL)
+    return 0;
+  r->options[0] = '\0';
+  r->num_metrics = 0;
+  while (fgets(line,sizeof(line),f)!=NULL)
+  {
+    if (!strncmp(line,"# options: ",11))
+    {
+      snprintf(r->options,sizeof(r->options),"%s",line + 11);
+      r->options[strcspn(r->options,"\r\n")] = '\0';
+      continue;
+    }
+    if (line[0]=='#' || r->num_metrics>=MAX_METRICS)
+      continue;
+    struct metric_t* m = &r->metrics[r->num_metrics];
+    if (sscanf(line,"%47s %lf",m->name,&m->value)==2)
+      r->num_metrics++;
+  }
+  fclose(f);
+  return 1;
+}
+
+static const struct metric_t* findMetric(const struct results_t* r,const char* name)
+{
+  for (int i=0; i<r->num_metrics; i++)
+    if (!strcmp(r->metrics[i].name,name))
+      return &r->metrics[i];
+  return NULL;
+}
+
+int main(int argc,char* argv[])
+{
+  //settings
+  const char* baselineName = NULL;
+  const char* resultsName = NULL;
+  double tolerance = 2.0; //%
+
+  for (int i=1; i<argc; i++)
+  {
+    if (!strcmp(argv[i],"-tolerance") && i+1<argc) tolerance = atof(argv[++i]);
+    else if (argv[i][0]!='-' && baselineName==NULL) baselineName = argv[i];
+    else if (argv[i][0]!='-' && resultsName==NULL) resultsName = argv[i];
+    else
+    {
+      fprintf(stderr,"unknown option: %s; see the top of WDT_compare.c for usage\n",argv[i]);
+      return 2;
+    }
+  }
+  if (resultsName==NULL)
+  {
+    fprintf(stderr,"usage: WDT_compare [-tolerance <%%>] baseline.txt results.txt; see the top of WDT_compare.c\n");
+    return 2;
+  }
+
+  if (!readResults(baselineName,&baseline))
+  {
+    fprintf(stderr,"can't read the baseline %s\n",baselineName);
+    return 2;
+  }
+  if (!readResults(resultsName,&results))
+  {
+    fprintf(stderr,"can't read the results %s\n",resultsName);
+    return 2;
+  }
+  if (baseline.num_metrics==0)
+  {
+    fprintf(stderr,"the baseline %s has no results; record one with \"make baseline\", & commit it\n",baselineName);
+    return 2;
+  }
+  if (strcmp(baseline.options,results.options))
+  {
+    fprintf(stderr,"the baseline %s was recorded with different options (%s, not %s); rebuild with those, or record a "
+            "new baseline\n",baselineName,baseline.options,results.options);
+    return 2;
+  }
+
+  //every metric, & the ones in only one of the 2 files
+  int regressions = 0;
+  int unmatched = 0;
+  printf("%-36s %12s %12s %9s\n","metric","value","baseline","change");
+  for (int i=0; i<results.num_metrics; i++)
+  {
+    const struct metric_t* m = &results.metrics[i];
+    const struct metric_t* b = findMetric(&baseline,m->name);
+    printf("%-36s %12.1f",m->name,m->value);
+    if (b==NULL)
+    {
+      printf(" %12s            NOT IN BASELINE\n","-");
+      unmatched++;
+      continue;
+    }
+    double change = (b->value!=0) ? 100.0*(m->value - b->value)/b->value : 0; //%
+    int worse = (m->value > b->value*(1.0 + tolerance/100.0));
+    regressions += worse;
+    printf(" %12.1f %+8.1f%%%s\n",b->value,change,worse ? "  REGRESSION" : "");
+  }
+  for (int i=0; i<baseline.num_metrics; i++)
+  {
+    const struct metric_t* b = &baseline.metrics[i];
+    if (findMetric(&results,b->name)==NULL)
+    {
+      printf("%-36s %12s %12.1f            NOT MEASURED\n",b->name,"-",b->value);
+      unmatched++;
+    }
+  }
+  printf("\n%d metric(s) worse than the baseline by more than %.1f%%, %d in only one of the 2 files\n",
+         regressions,tolerance,unmatched);
+  return (regressions>0 || unmatched>0) ? 1 : 0;
+}
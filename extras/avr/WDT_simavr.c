@@ -0,0 +1,325 @@
+/*
+WDT_simavr
+-runs the AVR benchmark firmware (WDT_avr_bench.cpp) under simavr, cycle by cycle, & reports the cost of the 
+ eRCaGuy_WDTimer library's hot paths; WDT_compare then compares them against a baseline
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+/*
+Usage: WDT_simavr [options] firmware.elf
+  -size <text> <data> <bss>  the firmware's section sizes, from avr-size; reported as flash_bytes (text + data) & 
+                             sram_static_bytes (data + bss)
+  -options <string>          the library options the firmware was built with; recorded with the results, & checked 
+                             against the baseline's by WDT_compare
+  -o <file>                  also write the results to this file, for WDT_compare, or to record a new baseline
+  -max-cycles <n>            give up if the firmware hasn't finished by then (default 2000000000)
+
+Metrics (all cycles are CPU cycles, at 16MHz; lower is better for all of them):
+  timedInterrupt_start_<ms>_cycles    one timedInterrupt(<ms>) call, with no timer running
+  timedInterrupt_restart_<ms>_cycles  one timedInterrupt(<ms>,_WDT_REPEAT) call, restarting it while it & another timer run
+  isr_<ms>_cycles_mean, _max          one ISR(WDT_vect) invocation, for a _WDT_REPEAT <ms> timer, from the jump to the 
+                                      vector up to its reti; it includes the call to the user function, which does nothing
+  isr_<ms>_per_call                   # of WDT interrupts per user function call
+  latency_<ms>_cycles_mean, _max      from the WDT interrupt flag being set, to the user function's first instruction
+  flash_bytes, sram_static_bytes      of the whole firmware (Arduino core included), which only the library changes
+The cost of the markers themselves, & the time spent in any other ISR (ex: Timer0's) in the middle of a call, are 
+subtracted from the call costs.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "sim_interrupts.h"
+#include "WDT_avr_bench.h"
+
+#define MCU "atmega328p"
+#define F_CPU 16000000UL
+#define WDT_VECTOR 6 //WDT_vect, on an ATmega328P
+#define TIMER0_OVF_VECTOR 16 //TIMER0_OVF_vect; the Arduino core's millis() interrupt
+#define GPIOR0_ADDR 0x3E //data space addresses (I/O address + 0x20)
+#define GPIOR1_ADDR 0x4A
+#define MAX_METRICS 64
+
+//per scenario results
+struct scenario_t
+{
+  unsigned long calls; //# of MARK_CALL_BEGIN/MARK_CALL_END pairs
+  uint64_t call_cycles; //all of them
+  unsigned long isrs; //# of WDT ISR invocations
+  uint64_t isr_cycles;
+  uint64_t isr_cycles_max;
+  unsigned long userCalls; //# of user function calls
+  uint64_t latency_cycles;
+  uint64_t latency_cycles_max;
+};
+
+struct metric_t
+{
+  char name[48];
+  double value;
+};
+
+static avr_t* avr;
+static struct scenario_t scenarios[NUM_SCENARIOS];
+static int scenario = -1; //the one running; -1 before the first one
+static int done = 0;
+static avr_cycle_count_t marker_cycles = 0; //cost of a marker; see SCENARIO_CALIBRATE
+static int in_call = 0; //1 between MARK_CALL_BEGIN & MARK_CALL_END
+static avr_cycle_count_t t_call_begin;
+static avr_cycle_count_t t_call_isrs; //cycles spent in ISRs since t_call_begin
+static avr_cycle_count_t t_isr_begin[2]; //of the WDT & the Timer0 ISRs
+static avr_cycle_count_t t_wdt_flag; //last time the WDT interrupt flag was set
+
+static struct metric_t metrics[MAX_METRICS];
+static int num_metrics = 0;
+
+//the firmware wrote a marker to GPIOR0
+static void gpior0_write(struct avr_t* avr,avr_io_addr_t addr,uint8_t v,void* param)
+{
+  (void)param;
+  avr->data[addr] = v; //it's still a register
+  avr_cycle_count_t t_now = avr->cycle;
+  struct scenario_t* s = (scenario>=0 && scenario<NUM_SCENARIOS) ? &scenarios[scenario] : NULL;
+  switch (v)
+  {
+    case MARK_SCENARIO:
+      scenario = avr->data[GPIOR1_ADDR];
+      break;
+    case MARK_CALL_BEGIN:
+      in_call = 1;
+      t_call_begin = t_now;
+      t_call_isrs = 0;
+      break;
+    case MARK_CALL_END:
+      in_call = 0;
+      if (scenario==SCENARIO_CALIBRATE)
+        marker_cycles = t_now - t_call_begin;
+      else if (s!=NULL)
+      {
+        s->calls++;
+        s->call_cycles += t_now - t_call_begin - t_call_isrs - marker_cycles;
+      }
+      break;
+    case MARK_USER_FUNC:
+      if (s!=NULL)
+      {
+        avr_cycle_count_t t_latency = t_now - t_wdt_flag;
+        s->userCalls++;
+        s->latency_cycles += t_latency;
+        if (t_latency > s->latency_cycles_max)
+          s->latency_cycles_max = t_latency;
+      }
+      break;
+    case MARK_DONE:
+      done = 1;
+      break;
+  }
+}
+
+//the WDT interrupt flag was set (value 1) or cleared (0)
+static void wdt_pending(struct avr_irq_t* irq,uint32_t value,void* param)
+{
+  (void)irq;
+  (void)param;
+  if (value)
+    t_wdt_flag = avr->cycle;
+}
+
+//an ISR was entered (value 1) or returned (0); param is 0 for the WDT ISR, 1 for the Timer0 one
+static void isr_running(struct avr_irq_t* irq,uint32_t value,void* param)
+{
+  (void)irq;
+  int isr = (int)(intptr_t)param;
+  if (value)
+  {
+    t_isr_begin[isr] = avr->cycle;
+    return;
+  }
+  avr_cycle_count_t t_isr = avr->cycle - t_isr_begin[isr];
+  if (in_call)
+    t_call_isrs += t_isr;
+  if (isr==0 && scenario>=0 && scenario<NUM_SCENARIOS)
+  {
+    struct scenario_t* s = &scenarios[scenario];
+    s->isrs++;
+    s->isr_cycles += t_isr;
+    if (t_isr > s->isr_cycles_max)
+      s->isr_cycles_max = t_isr;
+  }
+}
+
+static void addMetric(const char* name,long ms,const char* suffix,double value)
+{
+  if (num_metrics>=MAX_METRICS)
+    return;
+  struct metric_t* m = &metrics[num_metrics++];
+  if (ms>=0)
+    snprintf(m->name,sizeof(m->name),"%s_%ld%s",name,ms,suffix);
+  else
+    snprintf(m->name,sizeof(m->name),"%s%s",name,suffix);
+  m->value = value;
+}
+
+static int writeResults(const char* fileName,const char* options)
+{
+  FILE* f = fopen(fileName,"w");
+  if (f==NULL)
+    return 0;
+  fprintf(f,"# eRCaGuy_WDTimer AVR benchmark results (extras/avr); \"make baseline\" rewrites this file\n");
+  fprintf(f,"# options: %s\n",options);
+  for (int i=0; i<num_metrics; i++)
+    fprintf(f,"%s %.1f\n",metrics[i].name,metrics[i].value);
+  fclose(f);
+  return 1;
+}
+
+int main(int argc,char* argv[])
+{
+  //settings
+  const char* elfName = NULL;
+  const char* outName = NULL;
+  const char* options = "";
+  unsigned long long max_cycles = 2000000000ULL;
+  long size_text = -1;
+  long size_data = 0;
+  long size_bss = 0;
+  
+  for (int i=1; i<argc; i++)
+  {
+    int has_value = (i+1<argc);
+    if (!strcmp(argv[i],"-size") && i+3<argc)
+    {
+      size_text = atol(argv[++i]);
+      size_data = atol(argv[++i]);
+      size_bss = atol(argv[++i]);
+    }
+    else if (!strcmp(argv[i],"-options") && has_value) options = argv[++i];
+    else if (!strcmp(argv[i],"-o") && has_value) outName = argv[++i];
+    else if (!strcmp(argv[i],"-max-cycles") && has_value) max_cycles = strtoull(argv[++i],NULL,10);
+    else if (argv[i][0]!='-' && elfName==NULL) elfName = argv[i];
+    else
+    {
+      fprintf(stderr,"unknown option: %s; see the top of WDT_simavr.c for usage\n",argv[i]);
+      return 2;
+    }
+  }
+  if (elfName==NULL)
+  {
+    fprintf(stderr,"usage: WDT_simavr [options] firmware.elf; see the top of WDT_simavr.c\n");
+    return 2;
+  }
+  
+  //load the firmware
+  elf_firmware_t firmware;
+  memset(&firmware,0,sizeof(firmware));
+  if (elf_read_firmware(elfName,&firmware)!=0)
+  {
+    fprintf(stderr,"can't read %s\n",elfName);
+    return 2;
+  }
+  avr = avr_make_mcu_by_name(MCU);
+  if (avr==NULL)
+  {
+    fprintf(stderr,"simavr doesn't know the %s\n",MCU);
+    return 2;
+  }
+  avr_init(avr);
+  avr_load_firmware(avr,&firmware);
+  avr->frequency = F_CPU; //the .elf doesn't say
+  
+  //hook the markers & the interrupts
+  avr_register_io_write(avr,GPIOR0_ADDR,gpior0_write,NULL);
+  avr_irq_t* wdt_irq = avr_get_interrupt_irq(avr,WDT_VECTOR);
+  avr_irq_t* timer0_irq = avr_get_interrupt_irq(avr,TIMER0_OVF_VECTOR);
+  if (wdt_irq==NULL || timer0_irq==NULL)
+  {
+    fprintf(stderr,"can't find the WDT & Timer0 interrupts\n");
+    return 2;
+  }
+  avr_irq_register_notify(wdt_irq + AVR_INT_IRQ_PENDING,wdt_pending,NULL);
+  avr_irq_register_notify(wdt_irq + AVR_INT_IRQ_RUNNING,isr_running,(void*)(intptr_t)0);
+  avr_irq_register_notify(timer0_irq + AVR_INT_IRQ_RUNNING,isr_running,(void*)(intptr_t)1);
+  
+  //run it
+  int state = cpu_Running;
+  while (!done && state!=cpu_Done && state!=cpu_Crashed && avr->cycle < max_cycles)
+    state = avr_run(avr);
+  if (!done)
+  {
+    fprintf(stderr,"the firmware didn't finish (state %d, at cycle %llu)\n",state,(unsigned long long)avr->cycle);
+    return 2;
+  }
+  
+  //results
+  static const long delays[BENCH_NUM_DELAYS] = BENCH_DELAYS_MS;
+  static const long periods[BENCH_NUM_PERIODS] = BENCH_PERIODS_MS;
+  for (int i=0; i<BENCH_NUM_DELAYS; i++)
+  {
+    const struct scenario_t* s = &scenarios[SCENARIO_TIMED_START + i];
+    addMetric("timedInterrupt_start",delays[i],"_cycles",s->calls ? (double)s->call_cycles/s->calls : 0);
+  }
+  for (int i=0; i<BENCH_NUM_DELAYS; i++)
+  {
+    const struct scenario_t* s = &scenarios[SCENARIO_TIMED_RESTART + i];
+    addMetric("timedInterrupt_restart",delays[i],"_cycles",s->calls ? (double)s->call_cycles/s->calls : 0);
+  }
+  for (int i=0; i<BENCH_NUM_PERIODS; i++)
+  {
+    const struct scenario_t* s = &scenarios[SCENARIO_REPEAT + i];
+    addMetric("isr",periods[i],"_cycles_mean",s->isrs ? (double)s->isr_cycles/s->isrs : 0);
+    addMetric("isr",periods[i],"_cycles_max",(double)s->isr_cycles_max);
+    addMetric("isr",periods[i],"_per_call",s->userCalls ? (double)s->isrs/s->userCalls : 0);
+    addMetric("latency",periods[i],"_cycles_mean",s->userCalls ? (double)s->latency_cycles/s->userCalls : 0);
+    addMetric("latency",periods[i],"_cycles_max",(double)s->latency_cycles_max);
+  }
+  if (size_text>=0)
+  {
+    addMetric("flash_bytes",-1,"",(double)(size_text + size_data));
+    addMetric("sram_static_bytes",-1,"",(double)(size_data + size_bss));
+  }
+  
+  //report; see WDT_compare for the comparison with the baseline
+  printf("eRCaGuy_WDTimer on an %s at %luMHz, under simavr (options: %s)\n",MCU,F_CPU/1000000UL,options);
+  printf("marker cost subtracted: %llu cycles\n\n",(unsigned long long)marker_cycles);
+  for (int i=0; i<num_metrics; i++)
+    printf("%-36s %12.1f\n",metrics[i].name,metrics[i].value);
+  
+  if (outName!=NULL && !writeResults(outName,options))
+  {
+    fprintf(stderr,"can't write %s\n",outName);
+    return 2;
+  }
+  return 0;
+}
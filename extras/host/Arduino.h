@@ -0,0 +1,81 @@
+/*
+Arduino.h for the eRCaGuy_WDTimer host simulator
+-provides just enough of the Arduino core for the library to compile & run on a PC, against the virtual clock in WDT_sim.cpp
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define _BV(bit) (1 << (bit))
+#define F(string_literal) (string_literal)
+
+//an ISR is just a plain function on the host; the simulator calls it when the matching (virtual) interrupt fires
+#define ISR(vector) extern "C" void vector(void)
+
+//the AVR Status Register; only the global interrupt enable bit (bit 7) is modeled
+extern uint8_t SREG;
+#define noInterrupts() (SREG &= (uint8_t)~0x80)
+#define interrupts() (SREG |= 0x80)
+
+//time, from the simulated Timer0; uint32_t (ie: unsigned long on an AVR), so they roll over just like on an Arduino
+uint32_t millis();
+uint32_t micros();
+
+//Serial just prints to stdout
+class HardwareSerial
+{
+	public:
+		void print(const char* str);
+		void print(long n);
+		void print(unsigned long n);
+		void print(int n);
+		void print(unsigned int n); //uint32_t on a PC
+		void print(double n);
+		void println(const char* str="");
+		void println(long n);
+		void println(unsigned long n);
+		void println(int n);
+		void println(unsigned int n);
+		void println(double n);
+};
+extern HardwareSerial Serial;
+
+#endif
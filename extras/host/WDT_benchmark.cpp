@@ -0,0 +1,392 @@
+/*
+WDT_benchmark
+-replays _WDT_REPEAT periods of the eRCaGuy_WDTimer library across the range of valid delay times, on the host
+ simulator, & reports the jitter, cumulative drift & # of WDT wakeups of each one
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+/*
+Usage: WDT_benchmark [options]
+  -min <ms>         smallest dt_des (default 16)
+  -linear <ms>      every dt_des from -min up to this one is run (default 1024)...
+  -growth <x>       ...then dt_des is multiplied by this each step (default 1.25)...
+  -max <ms>         ...up to this one (default 2147483647)
+  -periods <n>      # of periods to run for each dt_des (default 3000); long dt_des values are run for fewer periods,
+                    so that each one takes at most ~1 million WDT wakeups
+  -slack <ms>       slack passed to wdt.attachInterrupt(); each period may then end up to this much early or late (default 0)
+  -jitter <x>       max fractional random error of each WDT period (default 0)
+  -drift <x>        fractional oscillator drift added to every WDT period (default 0)
+  -nominal          use a perfect WDT oscillator, rather than the measured errors in eRCaGuy_WDTimer.h
+  -calibrate        run wdt.calibrate(WDTO_8192MS) (against micros()) before the benchmark; -drift is only applied after it, so the
+                    calibration is off by that much, like after a temperature change
+  -bgcal            time every WDT delay for the background recalibration (wdt.setBackgroundCalibration(_WDT_CAL_EVERY)),
+                    rather than only a sample of them (the default, _WDT_CAL_AUTO); both track -drift
+  -nocal            turn the background recalibration off (_WDT_CAL_OFF), so the WDT delays keep their nominal lengths
+  -seed <n>         random # seed for the jitter (default 1)
+  -sleep            wait for each period in wdt.sleep() (power-down mode, so millis() stops), rather than awake
+  -awake <us>       time the main loop spends awake after each user function call, before sleeping again (default 0)
+  -func <us>        time each call to the user function takes (default 0); if it is more than dt_des, periods are missed
+  -overrun <policy> what the timer does when it misses periods: catchup (default), skip or reanchor (wdt.setOverrunPolicy())
+  -catchup <n>      max # of missed periods to catch up, with -overrun catchup (default 255)
+  -deferred         deferred mode (wdt.setDeferred()): the ISR only queues events, & the main loop calls wdt.dispatch()
+  -fixed            run the compile-time WDTimer<PeriodMs> front end, for a fixed list of periods, instead of the sweep
+  -csv              print one line per dt_des, in addition to the summary
+
+Output, per dt_des (all times are true, crystal, times):
+  jitter = the actual length of each period minus dt_des; the mean & max of its absolute value are reported
+  drift = (time of the last call to the user function - start time) - periods*dt_des; ie: the accumulated error
+  wakeups = # of WDT interrupts per period
+With -sleep, the awake duty cycle reported by the library (wdt.dutyCycle()) is also printed, next to the true one.
+When built with the library's timing statistics on ("make clean all WDT_STATS=1"), the library's own period error 
+histogram (wdt.stats()), summed over every dt_des, is printed too.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "WDT_sim.h"
+#include "eRCaGuy_WDTimer.h"
+
+//settings
+static unsigned long periods = 3000;
+static boolean use_sleep = false;
+static boolean deferred = false;
+static unsigned int t_slack_ms = 0;
+static unsigned long t_awake_us = 0;
+static unsigned long t_func_us = 0;
+static boolean csv = false;
+
+//results of the dt_des currently being run
+static unsigned long num_calls;
+static uint64_t t_last_call_us;
+static double sum_abs_jitter_ms;
+static double max_abs_jitter_ms;
+static long dt_des;
+
+//totals
+static unsigned long num_dt = 0;
+static unsigned long num_rejected = 0;
+static uint64_t total_periods = 0;
+static uint64_t total_wakeups = 0;
+static double total_abs_jitter_ms = 0;
+static double worst_abs_jitter_ms = 0;
+static long worst_jitter_dt = 0;
+static double worst_abs_drift_ms = 0;
+static long worst_drift_dt = 0;
+static unsigned long total_resets = 0;
+static unsigned long total_missed = 0;
+static unsigned long total_coalesced = 0;
+#if WDT_STATS
+static unsigned long total_histogram[WDT_STATS_BUCKETS];
+static unsigned int worst_wakeups = 0;
+static unsigned long total_overruns = 0;
+#endif
+
+void userFunc()
+{
+  uint64_t t_now_us = sim_now_us();
+  double jitter_ms = (double)(t_now_us - t_last_call_us)/1000.0 - (double)dt_des;
+  sum_abs_jitter_ms += fabs(jitter_ms);
+  if (fabs(jitter_ms) > max_abs_jitter_ms)
+    max_abs_jitter_ms = fabs(jitter_ms);
+  t_last_call_us = t_now_us;
+  num_calls++;
+  sim_consume(t_func_us);
+}
+
+//the runtime API
+static boolean beginRuntime()
+{
+  return wdt.attachInterrupt(userFunc,dt_des,_WDT_REPEAT,t_slack_ms);
+}
+
+static void stopRuntime()
+{
+  wdt.stop();
+}
+
+//the compile-time WDTimer<PeriodMs> API
+template <unsigned long PeriodMs>
+struct FixedPeriod
+{
+  static WDTimer<PeriodMs> timer;
+  static boolean begin() { timer.begin(userFunc); return true; }
+  static void stop() { timer.stop(); }
+};
+template <unsigned long PeriodMs>
+WDTimer<PeriodMs> FixedPeriod<PeriodMs>::timer;
+
+struct fixed_period_t
+{
+  long dt;
+  boolean (*begin)();
+  void (*stop)();
+};
+#define FIXED_PERIOD(ms) {ms,FixedPeriod<ms>::begin,FixedPeriod<ms>::stop}
+static const fixed_period_t fixed_periods[] = 
+{
+  FIXED_PERIOD(16), FIXED_PERIOD(17), FIXED_PERIOD(27), FIXED_PERIOD(31), FIXED_PERIOD(100), FIXED_PERIOD(250), 
+  FIXED_PERIOD(1000), FIXED_PERIOD(1001), FIXED_PERIOD(1023), FIXED_PERIOD(5000), FIXED_PERIOD(8191), FIXED_PERIOD(8192), 
+  FIXED_PERIOD(60000), FIXED_PERIOD(3600000), FIXED_PERIOD(86400000)
+};
+
+//run dt_des for the given # of periods, & add its results to the totals
+static void runOne(boolean (*begin)(),void (*stop)())
+{
+  //limit the # of WDT wakeups per dt_des, since very long periods are just a string of 8192ms ones anyway
+  unsigned long wakeups_per_period_est = (unsigned long)(dt_des/8192) + 10;
+  unsigned long periods_to_run = periods;
+  if (periods_to_run*wakeups_per_period_est > 1000000UL)
+    periods_to_run = 1000000UL/wakeups_per_period_est;
+  if (periods_to_run < 3)
+    periods_to_run = 3;
+  
+  num_calls = 0;
+  sum_abs_jitter_ms = 0;
+  max_abs_jitter_ms = 0;
+  unsigned long wakeups_start = sim_wdtInterrupts();
+  unsigned long resets_start = sim_wdtResets();
+  uint64_t t_start_us = sim_now_us();
+  t_last_call_us = t_start_us;
+#if WDT_STATS
+  wdt.resetStats();
+#endif
+  
+  if (!begin())
+    num_rejected++;
+  else
+  {
+    if (use_sleep)
+    {
+      while (num_calls < periods_to_run)
+      {
+        wdt.sleep();
+        if (deferred)
+          wdt.dispatch();
+        sim_consume(t_awake_us); //the rest of loop()
+      }
+    }
+    else
+    {
+      while (num_calls < periods_to_run && sim_step())
+      {
+        if (deferred)
+          wdt.dispatch();
+      }
+    }
+    stop();
+  }
+  
+#if WDT_STATS
+  WDT_stats_t stats;
+  wdt.stats(&stats);
+  for (byte i=0; i<WDT_STATS_BUCKETS; i++)
+    total_histogram[i] += stats.errorHistogram[i];
+  if (stats.wakeups_max > worst_wakeups)
+    worst_wakeups = stats.wakeups_max;
+  total_overruns += stats.overruns;
+#endif
+  total_missed += wdt.missedPeriods(_WDT_LEGACY_TIMER);
+  total_coalesced += wdt.coalescedPeriods(_WDT_LEGACY_TIMER);
+  
+  unsigned long wakeups = sim_wdtInterrupts() - wakeups_start;
+  total_resets += sim_wdtResets() - resets_start;
+  if (num_calls > 0)
+  {
+    double mean_abs_jitter_ms = sum_abs_jitter_ms/num_calls;
+    double drift_ms = (double)(t_last_call_us - t_start_us)/1000.0 - (double)num_calls*dt_des;
+    double drift_ppm = drift_ms/((double)num_calls*dt_des)*1e6;
+    double wakeups_per_period = (double)wakeups/num_calls;
+    if (csv)
+      printf("%ld,%lu,%.3f,%.3f,%.3f,%.1f,%.3f\n",dt_des,num_calls,mean_abs_jitter_ms,max_abs_jitter_ms,drift_ms,drift_ppm,wakeups_per_period);
+    
+    num_dt++;
+    total_periods += num_calls;
+    total_wakeups += wakeups;
+    total_abs_jitter_ms += sum_abs_jitter_ms;
+    if (max_abs_jitter_ms > worst_abs_jitter_ms)
+    {
+      worst_abs_jitter_ms = max_abs_jitter_ms;
+      worst_jitter_dt = dt_des;
+    }
+    if (fabs(drift_ms) > worst_abs_drift_ms)
+    {
+      worst_abs_drift_ms = fabs(drift_ms);
+      worst_drift_dt = dt_des;
+    }
+  }
+}
+
+int main(int argc,char* argv[])
+{
+  //settings
+  long dt_min = 16;
+  long dt_linear_max = 1024;
+  double growth = 1.25;
+  long dt_max = 2147483647L;
+  boolean fixed = false;
+  boolean calibrate = false;
+  byte calMode = _WDT_CAL_AUTO;
+  byte overrun = _WDT_OVERRUN_CATCH_UP;
+  byte maxCatchUp = 255;
+  sim_config_t config;
+  sim_defaultConfig(&config);
+  
+  for (int i=1; i<argc; i++)
+  {
+    boolean has_value = (i+1<argc);
+    if (!strcmp(argv[i],"-min") && has_value) dt_min = atol(argv[++i]);
+    else if (!strcmp(argv[i],"-linear") && has_value) dt_linear_max = atol(argv[++i]);
+    else if (!strcmp(argv[i],"-growth") && has_value) growth = atof(argv[++i]);
+    else if (!strcmp(argv[i],"-max") && has_value) dt_max = atol(argv[++i]);
+    else if (!strcmp(argv[i],"-periods") && has_value) periods = strtoul(argv[++i],NULL,10);
+    else if (!strcmp(argv[i],"-slack") && has_value) t_slack_ms = (unsigned int)atol(argv[++i]);
+    else if (!strcmp(argv[i],"-jitter") && has_value) config.jitter = atof(argv[++i]);
+    else if (!strcmp(argv[i],"-drift") && has_value) config.oscillatorDrift = atof(argv[++i]);
+    else if (!strcmp(argv[i],"-seed") && has_value) config.seed = strtoul(argv[++i],NULL,10);
+    else if (!strcmp(argv[i],"-nominal")) memset(config.wdtError,0,sizeof(config.wdtError));
+    else if (!strcmp(argv[i],"-calibrate")) calibrate = true;
+    else if (!strcmp(argv[i],"-bgcal")) calMode = _WDT_CAL_EVERY;
+    else if (!strcmp(argv[i],"-nocal")) calMode = _WDT_CAL_OFF;
+    else if (!strcmp(argv[i],"-sleep")) use_sleep = true;
+    else if (!strcmp(argv[i],"-awake") && has_value) t_awake_us = strtoul(argv[++i],NULL,10);
+    else if (!strcmp(argv[i],"-func") && has_value) t_func_us = strtoul(argv[++i],NULL,10);
+    else if (!strcmp(argv[i],"-overrun") && has_value)
+    {
+      i++;
+      if (!strcmp(argv[i],"catchup")) overrun = _WDT_OVERRUN_CATCH_UP;
+      else if (!strcmp(argv[i],"skip")) overrun = _WDT_OVERRUN_SKIP;
+      else if (!strcmp(argv[i],"reanchor")) overrun = _WDT_OVERRUN_REANCHOR;
+      else overrun = 0xFF; //invalid
+    }
+    else if (!strcmp(argv[i],"-catchup") && has_value) maxCatchUp = (byte)atoi(argv[++i]);
+    else if (!strcmp(argv[i],"-deferred")) deferred = true;
+    else if (!strcmp(argv[i],"-fixed")) fixed = true;
+    else if (!strcmp(argv[i],"-csv")) csv = true;
+    else
+    {
+      fprintf(stderr,"unknown option: %s; see the top of WDT_benchmark.cpp for usage\n",argv[i]);
+      return 1;
+    }
+  }
+  if (growth <= 1.0 || dt_min < 1 || periods < 1 || !wdt.setOverrunPolicy(_WDT_LEGACY_TIMER,overrun,maxCatchUp))
+  {
+    fprintf(stderr,"invalid settings\n");
+    return 1;
+  }
+  
+  double drift = config.oscillatorDrift;
+  if (calibrate)
+  {
+    config.oscillatorDrift = 0;
+    sim_begin(&config);
+    if (!wdt.calibrate(WDTO_8192MS)) //measure every delay, since simulated time is free
+    {
+      fprintf(stderr,"wdt.calibrate() failed\n");
+      return 1;
+    }
+    printf("calibration factors:          ");
+    for (byte period=WDTO_16MS; period<=WDTO_8192MS; period++)
+      printf(" %.5f",wdt.calibrationFactor(period));
+    printf("\n");
+    sim_setOscillatorDrift(drift);
+  }
+  else
+    sim_begin(&config);
+  if (calMode!=_WDT_CAL_AUTO)
+    wdt.setBackgroundCalibration(calMode); //(selecting _WDT_CAL_AUTO again would start it over, & undo -calibrate)
+  wdt.setDeferred(deferred);
+  wdt.setSleepMode(SLEEP_MODE_PWR_DOWN);
+  wdt.resetDutyCycle();
+  if (csv)
+    printf("dt_desired(ms),periods,mean_abs_jitter(ms),max_abs_jitter(ms),drift(ms),drift(ppm),wakeups_per_period\n");
+  
+#if WDT_STATS
+  wdt.setStatsTimer(fixed ? _WDT_CHAIN_TIMER : _WDT_LEGACY_TIMER);
+#endif
+  
+  if (fixed)
+  {
+    for (unsigned int i=0; i<sizeof(fixed_periods)/sizeof(fixed_periods[0]); i++)
+    {
+      dt_des = fixed_periods[i].dt;
+      runOne(fixed_periods[i].begin,fixed_periods[i].stop);
+    }
+  }
+  else
+  {
+    dt_des = dt_min;
+    while (dt_des <= dt_max && dt_des > 0)
+    {
+      runOne(beginRuntime,stopRuntime);
+      
+      //next dt_des
+      if (dt_des < dt_linear_max)
+        dt_des++;
+      else
+      {
+        double next = ceil((double)dt_des*growth);
+        if (next > (double)dt_max && dt_des < dt_max)
+          next = (double)dt_max; //always finish with dt_max itself
+        if (next > 2147483647.0)
+          break;
+        dt_des = (long)next;
+      }
+    }
+  }
+  
+  printf("dt_desired values run:         %lu (%lu rejected)\n",num_dt,num_rejected);
+  printf("total periods:                 %llu\n",(unsigned long long)total_periods);
+  printf("mean abs jitter:               %.3f ms\n",total_periods ? total_abs_jitter_ms/(double)total_periods : 0.0);
+  printf("worst abs jitter:              %.3f ms (dt_desired = %ld ms)\n",worst_abs_jitter_ms,worst_jitter_dt);
+  printf("worst abs cumulative drift:    %.3f ms (dt_desired = %ld ms)\n",worst_abs_drift_ms,worst_drift_dt);
+  printf("mean WDT wakeups per period:   %.3f\n",total_periods ? (double)total_wakeups/(double)total_periods : 0.0);
+  printf("total WDT wakeups:             %llu\n",(unsigned long long)total_wakeups);
+  printf("WDT resets:                    %lu\n",total_resets);
+  printf("missed periods:                %lu (%lu skipped)\n",total_missed,total_coalesced);
+  if (deferred)
+    printf("events dropped:                %lu\n",(unsigned long)wdt.eventOverflows());
+  printf("simulated time:                %.1f days\n",(double)sim_now_us()/86400e6);
+#if WDT_STATS
+  printf("library stats: error histogram (%d ms buckets):",WDT_STATS_BUCKET_MS);
+  for (byte i=0; i<WDT_STATS_BUCKETS; i++)
+    printf(" %lu",total_histogram[i]);
+  printf("\n");
+  printf("library stats: max wakeups/period: %u, overruns: %lu\n",worst_wakeups,total_overruns);
+#endif
+  if (use_sleep)
+  {
+    double true_duty = 100.0*(1.0 - (double)sim_asleep_us()/(double)sim_now_us());
+    printf("awake duty cycle:              %.4f %% (true: %.4f %%)\n",wdt.dutyCycle(),true_duty);
+  }
+  return 0;
+}
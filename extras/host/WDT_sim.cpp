@@ -0,0 +1,513 @@
+/*
+WDT_sim
+-a discrete-event, virtual-clock simulator of the ATmega328 Watchdog Timer & Timer0, for running & benchmarking the
+ eRCaGuy_WDTimer library on a PC; see WDT_sim.h
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "WDT_sim.h"
+
+extern "C" void WDT_vect(void); //the library's WDT ISR
+extern "C" void TIMER2_COMPA_vect(void) __attribute__((weak)); //the library's Timer2 ISR; only there in fine mode
+extern "C" void ADC_vect(void) __attribute__((weak)); //the library's ADC ISR; only there with the sampler
+
+uint8_t SREG = 0x80; //interrupts on
+HardwareSerial Serial;
+
+//simulator state
+static sim_config_t config;
+static uint64_t t_now_us; //us; true time
+static uint64_t t_timer0_us; //us; time counted by Timer0, which stops during most sleep modes
+static boolean timer0_running;
+static boolean timer0_pending; //a Timer0 overflow interrupt is pending, held off because interrupts are off
+static uint64_t t_asleep_us; //us; true time spent asleep
+static uint32_t rng_state; //xorshift32 state
+static boolean wdt_WDE; //WDT System Reset Mode enabled
+static boolean wdt_WDIE; //WDT Interrupt Mode enabled
+static byte wdt_period; //WDTO_* period
+static uint64_t t_wdt_timeout_us; //us; true time of the next WDT time-out
+static unsigned long num_wdt_interrupts;
+static unsigned long num_millis_reads; //by the library, through the HAL
+static unsigned long num_micros_reads;
+static unsigned long num_wdt_resets;
+static boolean mcu_halted; //true from WDT_HAL_systemReset() until the reset; the mcu would be stuck in a loop, waiting for it
+static boolean timer2_running; //Timer2 compare match A interrupt enabled & counting
+static uint64_t t_timer2_period_us; //us; CTC period
+static uint64_t t_timer2_match_us; //us; true time of the next compare match
+static unsigned long num_timer2_interrupts;
+static boolean adc_on; //ADC enabled, with its interrupt, by WDT_HAL_adcSampleBegin()
+static boolean adc_converting;
+static byte adc_channel;
+static uint64_t t_adc_done_us; //us; true time at which the conversion which is running ends
+static unsigned long num_adc_interrupts;
+static unsigned int (*adc_signal)(byte channel,uint64_t t_us); //NULL for a constant mid-scale input
+static byte eeprom[1024];
+static boolean eeprom_erased = false;
+
+#define TIMER0_OVERFLOW_US 1024 //us; 256 ticks of 4us, with a 16MHz Arduino's /64 prescaler
+
+//-------------------------------------------------------------------------------------------------------------------
+//simulator setup
+//-------------------------------------------------------------------------------------------------------------------
+void sim_defaultConfig(sim_config_t* cfg)
+{
+  //actual/calculated times from the table in eRCaGuy_WDTimer.h; the 1024 to 64ms ones have no % error listed there, so it is computed here
+  static const double measured_ms[10] = {15.914, 31.798, 63.570, 127.100, 254.160, 508.240, 1016.060, 2031.8, 4064.5, 8130.0};
+  for (byte i=0; i<10; i++)
+    cfg->wdtError[i] = measured_ms[i]/(double)(16UL << i) - 1.0;
+  cfg->oscillatorDrift = 0;
+  cfg->jitter = 0;
+  cfg->seed = 1;
+}
+
+void sim_begin(const sim_config_t* cfg)
+{
+  config = *cfg;
+  t_now_us = 0;
+  t_timer0_us = 0;
+  timer0_running = true;
+  timer0_pending = false;
+  t_asleep_us = 0;
+  rng_state = cfg->seed ? cfg->seed : 1;
+  wdt_WDE = false;
+  wdt_WDIE = false;
+  wdt_period = 0;
+  t_wdt_timeout_us = 0;
+  num_wdt_interrupts = 0;
+  num_millis_reads = 0;
+  num_micros_reads = 0;
+  num_wdt_resets = 0;
+  mcu_halted = false;
+  timer2_running = false;
+  t_timer2_period_us = 0;
+  t_timer2_match_us = 0;
+  num_timer2_interrupts = 0;
+  adc_on = false;
+  adc_converting = false;
+  adc_channel = 0;
+  t_adc_done_us = 0;
+  num_adc_interrupts = 0;
+  adc_signal = NULL;
+  SREG = 0x80;
+  if (!eeprom_erased)
+  {
+    memset(eeprom,0xFF,sizeof(eeprom));
+    eeprom_erased = true;
+  }
+}
+
+void sim_setOscillatorDrift(double drift)
+{
+  config.oscillatorDrift = drift;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//WDT model
+//-------------------------------------------------------------------------------------------------------------------
+//move the true time forward, & Timer0 along with it, if it's running
+//-millis() & micros() only count Timer0's overflows (every 1024us) in its overflow ISR, so while interrupts are off, 
+// only one overflow can be held pending (& be counted once they are back on); any others are lost, just like on an AVR
+static void advanceTo(uint64_t t_us)
+{
+  if (timer0_running)
+  {
+    uint64_t t_elapsed_us = t_us - t_now_us;
+    if (SREG & 0x80)
+      timer0_pending = false; //the overflow ISR has run
+    else
+    {
+      uint64_t numOverflows = (t_timer0_us % TIMER0_OVERFLOW_US + t_elapsed_us)/TIMER0_OVERFLOW_US;
+      if (numOverflows > 0 && !timer0_pending)
+      {
+        timer0_pending = true;
+        numOverflows--;
+      }
+      t_elapsed_us -= numOverflows*TIMER0_OVERFLOW_US; //lost
+    }
+    t_timer0_us += t_elapsed_us;
+  }
+  t_now_us = t_us;
+}
+
+//a uniform random # in [-1,1]
+static double randomUnit()
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return (double)rng_state/2147483647.5 - 1.0;
+}
+
+//us; the true length of one (more) WDT period
+static uint64_t wdtPeriod_us()
+{
+  double t_us = (double)(16000UL << wdt_period)*(1.0 + config.wdtError[wdt_period] + config.oscillatorDrift);
+  if (config.jitter!=0)
+    t_us *= 1.0 + config.jitter*randomUnit();
+  return (uint64_t)(t_us + 0.5);
+}
+
+void WDT_HAL_begin(byte period)
+{
+  if (mcu_halted)
+    return;
+  wdt_WDE = true;
+  wdt_WDIE = true;
+  wdt_period = period;
+  t_wdt_timeout_us = t_now_us + wdtPeriod_us();
+}
+
+void WDT_HAL_disable()
+{
+  if (mcu_halted)
+    return;
+  //wdt_disable() writes 0 to WDTCSR, so it clears WDIE too
+  wdt_WDE = false;
+  wdt_WDIE = false;
+}
+
+void WDT_HAL_disableInterrupt()
+{
+  wdt_WDIE = false;
+}
+
+boolean WDT_HAL_interruptPending()
+{
+  return wdt_WDIE && t_wdt_timeout_us <= t_now_us;
+}
+
+void WDT_HAL_armReset(byte period)
+{
+  if (mcu_halted)
+    return;
+  wdt_WDE = true;
+  wdt_WDIE = false;
+  wdt_period = period;
+  t_wdt_timeout_us = t_now_us + wdtPeriod_us();
+}
+
+void WDT_HAL_systemReset()
+{
+  WDT_HAL_armReset(0); //WDTO_16MS
+  timer2_running = false;
+  mcu_halted = true;
+}
+
+uint32_t WDT_HAL_millis()
+{
+  num_millis_reads++;
+  return millis();
+}
+
+uint32_t WDT_HAL_micros()
+{
+  num_micros_reads++;
+  return micros();
+}
+
+void WDT_HAL_busyWait()
+{
+  sim_step();
+}
+
+void WDT_HAL_addToMillis(uint32_t t_ms)
+{
+  t_timer0_us += (uint64_t)t_ms*1000;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//running the virtual clock
+//-------------------------------------------------------------------------------------------------------------------
+boolean sim_step()
+{
+  boolean wdt_on = wdt_WDE || wdt_WDIE;
+  if (!wdt_on && !timer2_running && !adc_converting)
+    return false; //all off, so nothing will ever happen
+  
+  //end of an ADC conversion, if it comes first
+  if (adc_converting && (!wdt_on || t_adc_done_us <= t_wdt_timeout_us) && (!timer2_running || t_adc_done_us <= t_timer2_match_us))
+  {
+    if (t_adc_done_us > t_now_us)
+      advanceTo(t_adc_done_us);
+    adc_converting = false;
+    num_adc_interrupts++;
+    uint8_t SREG_old = SREG;
+    noInterrupts(); //ISRs run with interrupts off
+    if (ADC_vect)
+      ADC_vect();
+    SREG = SREG_old;
+    return true;
+  }
+  
+  //Timer2 compare match, if it comes first
+  if (timer2_running && (!wdt_on || t_timer2_match_us <= t_wdt_timeout_us))
+  {
+    if (t_timer2_match_us > t_now_us)
+      advanceTo(t_timer2_match_us);
+    t_timer2_match_us += t_timer2_period_us; //CTC mode keeps counting, unless the ISR stops it
+    num_timer2_interrupts++;
+    uint8_t SREG_old = SREG;
+    noInterrupts(); //ISRs run with interrupts off
+    if (TIMER2_COMPA_vect)
+      TIMER2_COMPA_vect();
+    SREG = SREG_old;
+    return true;
+  }
+  
+  //if the code ran past the time-out, the interrupt was pending & fires right away
+  if (t_wdt_timeout_us > t_now_us)
+    advanceTo(t_wdt_timeout_us);
+  t_wdt_timeout_us += wdtPeriod_us(); //the WDT keeps counting, unless the ISR restarts it
+  
+  //...but in Interrupt & System Reset Mode, if it was held off past the next time-out too, that one resets the mcu
+  if (wdt_WDE && wdt_WDIE && t_wdt_timeout_us <= t_now_us)
+    wdt_WDIE = false;
+  
+  if (wdt_WDIE)
+  {
+    if (wdt_WDE)
+      wdt_WDIE = false; //in Interrupt & System Reset Mode, the hardware clears WDIE when the ISR runs; see datasheet pg. 55
+    num_wdt_interrupts++;
+    uint8_t SREG_old = SREG;
+    noInterrupts(); //ISRs run with interrupts off
+    WDT_vect();
+    SREG = SREG_old;
+  }
+  else //System Reset Mode only, or a held off interrupt (above)
+  {
+    num_wdt_resets++;
+    wdt_WDE = false; //the mcu would start over here; the simulator just records it & stops the WDT
+    mcu_halted = false;
+  }
+  return true;
+}
+
+//us; true time of the next interrupt (WDT time-out, Timer2 compare match, or end of an ADC conversion); UINT64_MAX if none
+static uint64_t nextInterrupt_us()
+{
+  uint64_t t_next_us = UINT64_MAX;
+  if (wdt_WDE || wdt_WDIE)
+    t_next_us = t_wdt_timeout_us;
+  if (timer2_running && t_timer2_match_us < t_next_us)
+    t_next_us = t_timer2_match_us;
+  if (adc_converting && t_adc_done_us < t_next_us)
+    t_next_us = t_adc_done_us;
+  return t_next_us;
+}
+
+//-with interrupts on (ex: code called from loop(), such as dispatch()), every interrupt which comes due in the meantime 
+// is serviced right then, just like on an AVR; with them off (ex: inside an ISR), they're held pending until the next
+// sim_step()
+void sim_consume(unsigned long t_us)
+{
+  uint64_t t_end_us = t_now_us + t_us;
+  while ((SREG & 0x80) && nextInterrupt_us() <= t_end_us && sim_step()) {}
+  if (t_end_us > t_now_us)
+    advanceTo(t_end_us);
+}
+
+void WDT_HAL_sleep(byte sleepMode,boolean disableBOD)
+{
+  (void)disableBOD;
+  interrupts();
+  uint64_t t_sleep_us = t_now_us;
+  boolean idle = (sleepMode==SLEEP_MODE_IDLE);
+  timer0_running = idle;
+  
+  //in SLEEP_MODE_ADC, an ADC conversion starts as soon as the mcu is asleep, if the ADC is on & idle
+  if (sleepMode==SLEEP_MODE_ADC && adc_on && !adc_converting)
+    WDT_HAL_adcStartConversion();
+  
+  //asleep until the next interrupt wakes us up; Timer2 can only do that in SLEEP_MODE_IDLE
+  boolean wdt_on = wdt_WDE || wdt_WDIE;
+  uint64_t t_wake_us = t_now_us;
+  if (idle && timer2_running && (!wdt_on || t_timer2_match_us < t_wdt_timeout_us))
+    t_wake_us = t_timer2_match_us;
+  else if (wdt_on)
+    t_wake_us = t_wdt_timeout_us;
+  if (adc_converting && (t_wake_us==t_now_us || t_adc_done_us < t_wake_us))
+    t_wake_us = t_adc_done_us;
+  if (t_wake_us > t_now_us)
+    advanceTo(t_wake_us);
+  if (!idle && timer2_running)
+    t_timer2_match_us += t_now_us - t_sleep_us; //Timer2 was stopped, too
+  
+  timer0_running = true; //...Timer0 starts back up as soon as we wake up, before the ISR runs
+  t_asleep_us += t_now_us - t_sleep_us;
+  sim_step();
+}
+
+void WDT_HAL_adcSampleBegin(byte channel)
+{
+  adc_on = true;
+  adc_channel = channel;
+}
+
+void WDT_HAL_adcStartConversion()
+{
+  if (!adc_on || adc_converting)
+    return;
+  adc_converting = true;
+  t_adc_done_us = t_now_us + 200; //the first conversion after turning the ADC on takes 25 ADC clocks, at 125kHz
+}
+
+unsigned int WDT_HAL_adcSampleEnd()
+{
+  adc_on = false;
+  adc_converting = false; //turning the ADC off aborts the conversion, if it's still running
+  return adc_signal ? adc_signal(adc_channel,t_adc_done_us) : 512;
+}
+
+void sim_setAdcSignal(unsigned int (*signal)(byte channel,uint64_t t_us))
+{
+  adc_signal = signal;
+}
+
+byte WDT_HAL_adcOff()
+{
+  return 0;
+}
+
+void WDT_HAL_adcRestore(byte ADCSRA_old)
+{
+  (void)ADCSRA_old;
+}
+
+uint32_t WDT_HAL_fineBegin(uint32_t t_us)
+{
+  uint32_t ticks = (t_us + 32)/64; //rounded to the nearest tick
+  if (ticks < 1)
+    ticks = 1;
+  else if (ticks > 255)
+    ticks = 255;
+  if (mcu_halted)
+    return ticks*64;
+  timer2_running = true;
+  t_timer2_period_us = ticks*64;
+  t_timer2_match_us = t_now_us + t_timer2_period_us;
+  return ticks*64;
+}
+
+void WDT_HAL_fineStop()
+{
+  timer2_running = false;
+}
+
+boolean WDT_HAL_finePending()
+{
+  return timer2_running && t_timer2_match_us <= t_now_us;
+}
+
+void WDT_HAL_eepromRead(int address,void* data,size_t size)
+{
+  for (size_t i=0; i<size; i++)
+    ((byte*)data)[i] = (address + i < sizeof(eeprom)) ? eeprom[address + i] : 0xFF;
+}
+
+void WDT_HAL_eepromWrite(int address,const void* data,size_t size)
+{
+  for (size_t i=0; i<size; i++)
+    if (address + i < sizeof(eeprom))
+      eeprom[address + i] = ((const byte*)data)[i];
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//status
+//-------------------------------------------------------------------------------------------------------------------
+uint64_t sim_now_us()
+{
+  return t_now_us;
+}
+
+unsigned long sim_wdtInterrupts()
+{
+  return num_wdt_interrupts;
+}
+
+unsigned long sim_millisReads()
+{
+  return num_millis_reads;
+}
+
+unsigned long sim_microsReads()
+{
+  return num_micros_reads;
+}
+
+unsigned long sim_timer2Interrupts()
+{
+  return num_timer2_interrupts;
+}
+
+unsigned long sim_adcInterrupts()
+{
+  return num_adc_interrupts;
+}
+
+unsigned long sim_wdtResets()
+{
+  return num_wdt_resets;
+}
+
+uint64_t sim_asleep_us()
+{
+  return t_asleep_us;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//Arduino core functions
+//-they return uint32_t, like an AVR's 32-bit unsigned long, so they roll over at the same points (every 49.7 days & 
+// 71.6 minutes), & the library's time stamp arithmetic is done in 32 bits, just like on an AVR
+//-------------------------------------------------------------------------------------------------------------------
+uint32_t millis()
+{
+  return (uint32_t)(t_timer0_us/1000);
+}
+
+uint32_t micros()
+{
+  return (uint32_t)t_timer0_us;
+}
+
+void HardwareSerial::print(const char* str) { fputs(str,stdout); }
+void HardwareSerial::print(long n) { printf("%ld",n); }
+void HardwareSerial::print(unsigned long n) { printf("%lu",n); }
+void HardwareSerial::print(int n) { printf("%d",n); }
+void HardwareSerial::print(unsigned int n) { printf("%u",n); }
+void HardwareSerial::print(double n) { printf("%.2f",n); }
+void HardwareSerial::println(const char* str) { printf("%s\n",str); }
+void HardwareSerial::println(long n) { printf("%ld\n",n); }
+void HardwareSerial::println(unsigned long n) { printf("%lu\n",n); }
+void HardwareSerial::println(int n) { printf("%d\n",n); }
+void HardwareSerial::println(unsigned int n) { printf("%u\n",n); }
+void HardwareSerial::println(double n) { printf("%.2f\n",n); }
@@ -0,0 +1,122 @@
+/*
+WDT_sim
+-a discrete-event, virtual-clock simulator of the ATmega328 Watchdog Timer & Timer0, for running & benchmarking the
+ eRCaGuy_WDTimer library on a PC
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+  
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+  
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+/*
+-Time only moves when the program tells it to: sim_step() jumps straight to the next WDT time-out & runs the WDT ISR,
+ and sim_consume() models time spent executing code (ex: inside a user function), servicing any interrupts which come 
+ due meanwhile if interrupts are on, just like the mcu would.  So simulating hours of WDT periods takes milliseconds.
+-The "true" time (sim_now_us()) is the crystal time; millis() & micros() are derived from it, just like Timer0, 
+ except that Timer0 stops while asleep in any sleep mode other than SLEEP_MODE_IDLE, & that, like on an AVR, it loses 
+ all but one of its overflows (1024us each) while interrupts are off (ex: inside an ISR).
+-millis() & micros() are 32 bits, & the library is written with fixed-width types, so its time stamp arithmetic & 
+ roll-overs are the same as on an AVR, even though a long is 64 bits on a PC.
+-The ADC (only used by the library's sampler) is modeled as a 200us conversion, started either explicitly, or by 
+ going to sleep in SLEEP_MODE_ADC, whose input is set by sim_setAdcSignal().
+-Timer2 (only used by the library's fine mode) is modeled too, on the crystal time, in 64us ticks; like Timer0, it 
+ stops while asleep in any sleep mode other than SLEEP_MODE_IDLE.
+-Each WDT period lasts its nominal length (16ms << WDTO_*), times (1 + its error), where the default errors are the
+ measured values from the table at the top of eRCaGuy_WDTimer.h; an optional uniform random jitter & a common
+ oscillator drift (ex: from temperature or voltage) can be added on top.
+*/
+
+#ifndef WDT_sim_h
+#define WDT_sim_h
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+
+//sleep modes, with the same values as in <avr/sleep.h> for the ATmega328
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 2
+#define SLEEP_MODE_PWR_DOWN 4
+#define SLEEP_MODE_PWR_SAVE 6
+#define SLEEP_MODE_STANDBY 12
+#define SLEEP_MODE_EXT_STANDBY 14
+
+//the HAL functions; see eRCaGuy_WDTimer_HAL.h
+void WDT_HAL_begin(byte period);
+void WDT_HAL_disable();
+void WDT_HAL_disableInterrupt();
+boolean WDT_HAL_interruptPending();
+void WDT_HAL_armReset(byte period);
+void WDT_HAL_systemReset(); //the mcu would stop right here, & reset 16ms later; the simulator returns, but ignores the WDT & Timer2 until that reset
+#define WDT_HAL_NOINIT //the simulator never clears the library's variables anyway
+uint32_t WDT_HAL_millis();
+uint32_t WDT_HAL_micros();
+void WDT_HAL_busyWait(); //services the next WDT time-out, since nothing else would ever move the virtual clock forward
+void WDT_HAL_addToMillis(uint32_t t_ms);
+void WDT_HAL_sleep(byte sleepMode,boolean disableBOD); //sleeps until the next WDT time-out, which is serviced before this returns
+byte WDT_HAL_adcOff();
+void WDT_HAL_adcSampleBegin(byte channel);
+void WDT_HAL_adcStartConversion(); //each conversion takes 200us (the first one after turning the ADC on, at 125kHz)
+unsigned int WDT_HAL_adcSampleEnd();
+void WDT_HAL_adcRestore(byte ADCSRA_old);
+#define WDT_HAL_FINE_RESOLUTION_US 64 //a 16MHz Arduino's Timer2, with the /1024 prescaler
+uint32_t WDT_HAL_fineBegin(uint32_t t_us);
+void WDT_HAL_fineStop();
+boolean WDT_HAL_finePending();
+void WDT_HAL_eepromRead(int address,void* data,size_t size); //a 1KB EEPROM, like the ATmega328's; only the first sim_begin() erases it (to 0xFF), so it survives simulated resets
+void WDT_HAL_eepromWrite(int address,const void* data,size_t size);
+
+//simulator settings
+struct sim_config_t
+{
+	double wdtError[10]; //fractional error of each WDTO_* period; ie: (actual/nominal - 1)
+	double oscillatorDrift; //fractional error added to every WDT period (ex: a temperature or voltage change)
+	double jitter; //max fractional random error of each WDT period; each one is off by a uniform random amount within +/-jitter
+	uint32_t seed; //seed of the random # generator used for the jitter, so that runs are repeatable
+};
+
+void sim_defaultConfig(sim_config_t* config); //the measured errors from the eRCaGuy_WDTimer.h table; no drift, no jitter
+void sim_begin(const sim_config_t* config); //(re)start the simulator at time zero, with the WDT off & a constant ADC input
+void sim_setOscillatorDrift(double drift); //change config.oscillatorDrift on the fly (ex: a temperature change), from the next WDT period on
+void sim_setAdcSignal(unsigned int (*signal)(byte channel,uint64_t t_us)); //the ADC input, as a function of true time; NULL (the default) for a constant 512
+
+//running the virtual clock
+boolean sim_step(); //jump to the next WDT time-out (or Timer2 compare match, or end of an ADC conversion) & service it; returns false (& does nothing) if all are off
+void sim_consume(unsigned long t_us); //time spent executing code; with interrupts on, it services the interrupts which come due meanwhile, & with them off (ex: in an ISR), it leaves them pending
+
+//status
+uint64_t sim_now_us(); //us; true time since sim_begin()
+unsigned long sim_wdtInterrupts(); //# of times the WDT ISR has been called since sim_begin()
+unsigned long sim_millisReads(); //# of times the library has read millis() (WDT_HAL_millis()) since sim_begin()
+unsigned long sim_microsReads(); //# of times the library has read micros() (WDT_HAL_micros()) since sim_begin()
+unsigned long sim_timer2Interrupts(); //# of times the Timer2 compare match ISR has been called since sim_begin()
+unsigned long sim_adcInterrupts(); //# of ADC conversions completed since sim_begin()
+unsigned long sim_wdtResets(); //# of times the WDT would have reset the mcu since sim_begin(): a time-out in System Reset Mode, or one in Interrupt & System Reset Mode while the last interrupt is still held off
+uint64_t sim_asleep_us(); //us; true time spent asleep since sim_begin()
+
+#endif
@@ -0,0 +1,900 @@
+/*
+WDT_test
+-checks of the eRCaGuy_WDTimer library's behaviour, run on a PC against the virtual-clock WDT simulator (WDT_sim.cpp)
+By Gabriel Staples
+Website: http://electricrcaircraftguy.blogspot.com
+Written: 16 Oct 2026
+*/
+
+/*
+===================================================================================================
+  LICENSE & DISCLAIMER
+  Copyright (C) 2014 Gabriel Staples.  All right reserved.
+
+  ------------------------------------------------------------------------------------------------
+  License: GNU General Public License Version 3 (GPLv3) - https://www.gnu.org/licenses/gpl.html
+  ------------------------------------------------------------------------------------------------
+
+  This file is part of eRCaGuy_WDTimer.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see http://www.gnu.org/licenses/
+===================================================================================================
+*/
+
+/*
+Usage: WDT_test
+-runs every test below, prints each check which fails, & returns the # of failures (so 0 means they all passed)
+-"make test" builds & runs it; "make test-all" also runs it with WDT_STATS, WDT_FINE & WDT_SAMPLER, which some tests need
+-the library is one global object (wdt), so each test stops every timer it started before it returns; the time base
+ (now(), now64()) is never reset, so the tests only ever look at differences in it
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "WDT_sim.h"
+#include "eRCaGuy_WDTimer.h"
+
+static unsigned int num_checks = 0;
+static unsigned int num_failures = 0;
+
+#define CHECK(condition) check((condition),#condition,__LINE__)
+static void check(boolean passed,const char* condition,int line)
+{
+  num_checks++;
+  if (!passed)
+  {
+    num_failures++;
+    printf("  FAILED (line %d): %s\n",line,condition);
+  }
+}
+
+//ms; how close to its deadline each call is; without fine mode, the shortest WDT delay (16ms) is the step size
+#if WDT_FINE
+ #define T_RESOLUTION 1
+#else
+ #define T_RESOLUTION 8
+#endif
+
+//started once, with a perfect WDT oscillator, so that every time can be checked exactly; it's never restarted, since 
+//that would move millis() back, under the library's feet
+static void beginNominal()
+{
+  sim_config_t config;
+  sim_defaultConfig(&config);
+  for (byte i=0; i<10; i++)
+    config.wdtError[i] = 0;
+  sim_begin(&config);
+}
+
+//us; |t1_us - t2_us|
+static uint64_t usDiff(uint64_t t1_us,uint64_t t2_us)
+{
+  return (t1_us > t2_us) ? t1_us - t2_us : t2_us - t1_us;
+}
+
+//run the simulator for t_us of true time
+static void runFor(uint64_t t_us)
+{
+  uint64_t t_end_us = sim_now_us() + t_us;
+  while (sim_now_us() < t_end_us && sim_step()) {}
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//addTimer() & cancelTimer(): the timers are called in deadline order, no matter the order they were added in; a 
+//_WDT_DO_ONCE timer frees its slot; & no timer can be started while a WDTimer<PeriodMs> owns the WDT
+//-------------------------------------------------------------------------------------------------------------------
+static uint32_t num_tick_calls;
+static void tickFunc()
+{
+  num_tick_calls++;
+}
+
+static char callOrder[8]; //which timer functions were called, in order
+static byte numCallOrder;
+static void orderFunc(char name)
+{
+  if (numCallOrder < sizeof(callOrder) - 1)
+    callOrder[numCallOrder++] = name;
+  callOrder[numCallOrder] = '\0';
+}
+static void funcA() { orderFunc('A'); }
+static void funcB() { orderFunc('B'); }
+static void funcC() { orderFunc('C'); }
+
+static void testTimers()
+{
+  numCallOrder = 0;
+  callOrder[0] = '\0';
+  byte idC = wdt.addTimer(funcC,300);
+  byte idA = wdt.addTimer(funcA,100);
+  byte idB = wdt.addTimer(funcB,200);
+  CHECK(idA!=_WDT_NO_TIMER && idB!=_WDT_NO_TIMER && idC!=_WDT_NO_TIMER);
+  CHECK(idA!=idB && idB!=idC && idC!=idA && idA!=_WDT_LEGACY_TIMER);
+  CHECK(wdt.addTimer(tickFunc,1000)==_WDT_NO_TIMER); //all WDT_MAX_TIMERS-1 slots are in use
+  runFor(400000);
+  CHECK(strcmp(callOrder,"ABC")==0);
+  CHECK(!wdt.cancelTimer(idA)); //already done; its slot is free again
+  
+  //cancelling the earliest timer, & one in the middle of the heap, leaves the others' order alone
+  numCallOrder = 0;
+  callOrder[0] = '\0';
+  idA = wdt.addTimer(funcA,100,_WDT_REPEAT);
+  idB = wdt.addTimer(funcB,150,_WDT_REPEAT);
+  idC = wdt.addTimer(funcC,50);
+  CHECK(wdt.cancelTimer(idC));
+  CHECK(!wdt.cancelTimer(idC));
+  runFor(320000); //A at 100, B at 150, A at 200, B & A at 300
+  CHECK(strcmp(callOrder,"ABABA")==0 || strcmp(callOrder,"ABAAB")==0);
+  CHECK(wdt.cancelTimer(idA));
+  numCallOrder = 0;
+  callOrder[0] = '\0';
+  runFor(300000);
+  CHECK(strcmp(callOrder,"BB")==0);
+  CHECK(wdt.cancelTimer(idB));
+  CHECK(wdt.addTimer(tickFunc,0)==_WDT_NO_TIMER); //too short
+  
+  //a WDTimer<PeriodMs> owns the WDT until it's stopped
+  WDTimer<1000> chain;
+  chain.begin(tickFunc);
+  CHECK(wdt.addTimer(tickFunc,1000)==_WDT_NO_TIMER);
+  CHECK(!wdt.timedInterrupt(1000)); //prints why
+  chain.stop();
+  byte id = wdt.addTimer(tickFunc,1000);
+  CHECK(id!=_WDT_NO_TIMER);
+  wdt.cancelTimer(id);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//atTime() & everyAligned(), against a time set with setNow(): the first aligned call is on the next boundary still 
+
+//-------------------------------------------------------------------------------------------------------------------
+//Timer0 (millis() & micros()) loses all but one of its overflows while interrupts are off, like on an AVR
+//-------------------------------------------------------------------------------------------------------------------
+static void testTimer0HeldOff()
+{
+  uint32_t t_start_us = micros();
+  noInterrupts();
+  sim_consume(100000); //100ms
+  CHECK(micros() - t_start_us < 2048); //up to the 1st overflow (held pending), plus Timer0's count since the last one
+  interrupts();
+  sim_consume(5000);
+  CHECK(micros() - t_start_us >= 5000 && micros() - t_start_us < 7048);
+
+  //no loss with interrupts on
+  t_start_us = micros();
+  sim_consume(100000);
+  CHECK(micros() - t_start_us == 100000);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//32-bit roll-overs: millis() & micros() roll over like on an AVR, & the time base carries on past 2^32 ms (49.7 days)
+//into now64(), with atTime() & everyAligned() staying on time across that point
+//-------------------------------------------------------------------------------------------------------------------
+static uint32_t num_hourly_calls;
+static uint64_t t_hourly_last_us;
+static uint64_t t_hourly_worst_error_us;
+static void hourlyFunc()
+{
+  uint64_t t_us = sim_now_us();
+  if (num_hourly_calls > 0)
+  {
+    uint64_t t_period_us = t_us - t_hourly_last_us;
+    uint64_t t_error_us = usDiff(t_period_us,3600000000ULL);
+    if (t_error_us > t_hourly_worst_error_us)
+      t_hourly_worst_error_us = t_error_us;
+  }
+  t_hourly_last_us = t_us;
+  num_hourly_calls++;
+}
+
+static uint32_t num_aligned_calls;
+static uint32_t num_aligned_misaligned;
+static uint64_t t_aligned_first64;
+static uint64_t t_aligned_last64;
+static void alignedFunc()
+{
+  uint64_t t_now64 = wdt.now64();
+  if (num_aligned_calls==0)
+    t_aligned_first64 = t_now64;
+  int32_t t_error = (int32_t)(t_now64 % 7000) - 1234;
+  if (t_error < -T_RESOLUTION || t_error > T_RESOLUTION)
+    num_aligned_misaligned++;
+  t_aligned_last64 = t_now64;
+  num_aligned_calls++;
+}
+
+static uint64_t t_at_called64;
+static uint64_t t_at_called_us;
+static void atFunc()
+{
+  t_at_called64 = wdt.now64();
+  t_at_called_us = sim_now_us();
+}
+
+static void testRollOver()
+{
+  sim_consume(0xFFFFFFFFUL - micros()); //us; up to 1us before micros() rolls over
+  CHECK(micros()==0xFFFFFFFFUL);
+  sim_consume(2);
+  CHECK(micros()==1);
+
+  num_hourly_calls = 0;
+  t_hourly_worst_error_us = 0;
+  uint64_t t_start64 = wdt.now64();
+  uint32_t t_start = wdt.now();
+  uint64_t t_start_us = sim_now_us();
+  CHECK(wdt.attachInterrupt(hourlyFunc,3600000,_WDT_REPEAT));
+
+  //up to 1 day before the time base rolls over, then set an atTime() for 1 day after it, & start an everyAligned() timer
+  uint64_t t_rollover64 = (t_start64 | 0xFFFFFFFFULL) + 1;
+  runFor((t_rollover64 - t_start64 - 86400000ULL)*1000);
+  uint64_t t_at64 = t_rollover64 + 86400000ULL + 12345;
+  t_at_called64 = 0;
+  byte atID = wdt.atTime(atFunc,t_at64);
+  CHECK(atID!=_WDT_NO_TIMER);
+  num_aligned_calls = 0;
+  num_aligned_misaligned = 0;
+  byte alignedID = wdt.everyAligned(alignedFunc,7000,1234);
+  CHECK(alignedID!=_WDT_NO_TIMER);
+
+  //to 2 days after it
+  runFor(3*86400000000ULL);
+  uint64_t t_now64 = wdt.now64();
+  CHECK(t_now64 > t_rollover64);
+  CHECK(wdt.now()==(uint32_t)(t_now64 - t_start64) + t_start);
+  CHECK(usDiff((t_now64 - t_start64)*1000,sim_now_us() - t_start_us) < 5000); //a perfect oscillator, so the time base is exact, but for rounding
+  CHECK(num_hourly_calls==(uint32_t)((sim_now_us() - t_start_us)/3600000000ULL));
+  CHECK(t_hourly_worst_error_us < 1000);
+  CHECK(t_at_called64 + T_RESOLUTION >= t_at64 && t_at_called64 <= t_at64 + T_RESOLUTION);
+  CHECK(usDiff(t_at_called_us - t_start_us,(t_at_called64 - t_start64)*1000) < 5000);
+  CHECK(num_aligned_calls>=3*86400000UL/7000 && num_aligned_calls<=3*86400000UL/7000 + 1);
+  CHECK(num_aligned_misaligned==0);
+  CHECK(t_aligned_last64 > t_rollover64); //so the low half of now64() % 7000 was exercised past the roll-over too
+
+  wdt.stop();
+  wdt.cancelTimer(alignedID);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//sleep(): what it returns, & awakeTime(), sleptTime() & dutyCycle(), against the time the simulated mcu was really 
+//asleep, with some work done while awake in between
+//-------------------------------------------------------------------------------------------------------------------
+static void testSleep()
+{
+  CHECK(wdt.sleep()==0); //no timers, so it returns right away
+  num_tick_calls = 0;
+  CHECK(wdt.attachInterrupt(tickFunc,100,_WDT_REPEAT));
+  wdt.resetDutyCycle();
+  uint64_t t_start_us = sim_now_us();
+  uint64_t t_asleep_start_us = sim_asleep_us();
+  uint32_t t_returned = 0; //ms
+  for (byte i=0; i<50; i++)
+  {
+    t_returned += wdt.sleep();
+    sim_consume(25000); //25ms of work, awake
+  }
+  uint64_t t_total_us = sim_now_us() - t_start_us;
+  uint64_t t_asleep_us = sim_asleep_us() - t_asleep_start_us;
+  CHECK(num_tick_calls==50);
+  CHECK(t_returned==wdt.sleptTime());
+  CHECK(usDiff((uint64_t)wdt.sleptTime()*1000,t_asleep_us) < 5000); //a perfect oscillator, so they're exact, but for rounding
+  CHECK(usDiff((uint64_t)wdt.awakeTime()*1000,t_total_us - t_asleep_us) < 5000);
+  float dutyCycle = (float)(t_total_us - t_asleep_us)*100.0/(float)t_total_us; //%; the true one, ~25%
+  CHECK(dutyCycle > 20 && dutyCycle < 30);
+  CHECK(wdt.dutyCycle() > dutyCycle - 0.1 && wdt.dutyCycle() < dutyCycle + 0.1);
+  wdt.stop();
+  wdt.syncMillis(); //so the time base test can see what its own sleeps leave millis() missing
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//WDTimer<PeriodMs>: the chain's periods are whole 16ms delays, & the remainder (PeriodMs%16) is paid back with an 
+//extra 16ms delay whenever it adds up to 16ms, so the long term period is exact; periods over 8192ms too
+//-------------------------------------------------------------------------------------------------------------------
+static uint64_t t_chainCalls_us[20]; //us; the true time of each call
+static byte numChainCalls;
+static void chainFunc()
+{
+  if (numChainCalls < sizeof(t_chainCalls_us)/sizeof(t_chainCalls_us[0]))
+    t_chainCalls_us[numChainCalls] = sim_now_us();
+  numChainCalls++;
+}
+
+static void testChain()
+{
+  //1005ms = 62 x 16ms + 13ms: 992ms periods, 13 in every 16 of them 16ms longer
+  WDTimer<1005> chain;
+  numChainCalls = 0;
+  uint64_t t_start_us = sim_now_us();
+  chain.begin(chainFunc);
+  runFor(16*1005000UL + 500000);
+  chain.stop();
+  CHECK(numChainCalls==16);
+  byte numLong = 0;
+  uint64_t t_last_us = t_start_us;
+  for (byte i=0; i<16; i++)
+  {
+    uint64_t t_period_us = t_chainCalls_us[i] - t_last_us;
+    numLong += (t_period_us==1008000);
+    CHECK(t_period_us==992000 || t_period_us==1008000);
+    t_last_us = t_chainCalls_us[i];
+  }
+  CHECK(numLong==13);
+  CHECK(t_chainCalls_us[15] - t_start_us==16*1005000UL); //exact, once the remainder is all paid back
+  
+  //20000ms = 2 x 8192ms + 3616ms, & no remainder
+  WDTimer<20000> longChain;
+  numChainCalls = 0;
+  t_start_us = sim_now_us();
+  longChain.begin(chainFunc);
+  runFor(3*20000000UL + 500000);
+  longChain.stop();
+  CHECK(numChainCalls==3);
+  CHECK(t_chainCalls_us[0] - t_start_us==20000000UL);
+  CHECK(t_chainCalls_us[2] - t_start_us==3*20000000UL);
+}
+
+#if WDT_FINE
+//-------------------------------------------------------------------------------------------------------------------
+//fine mode: periods from 1ms up are valid, & Timer2 finishes each one to within a tick (64us), rather than the 
+//nearest 16ms WDT delay; the long term period stays exact
+//-------------------------------------------------------------------------------------------------------------------
+static void testFine()
+{
+  CHECK(wdt.addTimer(chainFunc,0)==_WDT_NO_TIMER);
+  const uint32_t t_periods_us[] = {1000,21000,100000}; //us; Timer2 only, the 16ms WDT delay + Timer2, & several WDT delays + Timer2
+  for (byte p=0; p<sizeof(t_periods_us)/sizeof(t_periods_us[0]); p++)
+  {
+    numChainCalls = 0;
+    uint64_t t_start_us = sim_now_us();
+    byte id = wdt.addTimer(chainFunc,t_periods_us[p]/1000,_WDT_REPEAT);
+    CHECK(id!=_WDT_NO_TIMER);
+    sim_consume(16*t_periods_us[p] + t_periods_us[p]/2); //interrupts on, as in loop(), so it stops right there
+    wdt.cancelTimer(id);
+    CHECK(numChainCalls==16);
+    uint64_t t_last_us = t_start_us;
+    uint64_t t_worst_us = 0;
+    for (byte i=0; i<16; i++)
+    {
+      uint64_t t_error_us = usDiff(t_chainCalls_us[i] - t_last_us,t_periods_us[p]);
+      if (t_error_us > t_worst_us)
+        t_worst_us = t_error_us;
+      t_last_us = t_chainCalls_us[i];
+    }
+    CHECK(t_worst_us < WDT_HAL_FINE_RESOLUTION_US*2); //each period, to within about a tick
+    CHECK(usDiff(t_chainCalls_us[15] - t_start_us,16*t_periods_us[p]) < WDT_HAL_FINE_RESOLUTION_US); //the remainders are paid back
+  }
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------
+//loadCalibration() checks each delay in the record against nominal, like calibrate() does, not just the checksum
+//-------------------------------------------------------------------------------------------------------------------
+static void testCalibrationRecord()
+{
+  WDT_calibration_t record;
+  wdt.saveCalibration(0);
+  CHECK(wdt.loadCalibration(0));
+  
+  WDT_HAL_eepromRead(0,&record,sizeof(record));
+  record.segment_q8[WDTO_16MS] = 0; //a valid checksum, but a 0ms delay
+  byte sum = 0;
+  for (byte i=0; i<(byte)offsetof(WDT_calibration_t,checksum); i++)
+    sum += ((const byte*)&record)[i];
+  record.checksum = sum;
+  WDT_HAL_eepromWrite(0,&record,sizeof(record));
+  CHECK(!wdt.loadCalibration(0));
+  CHECK(wdt.calibrationFactor(WDTO_16MS)==1.0); //left as is
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//deferred mode: the ISR only queues the events, oldest first, & drops the newest ones (counting them) once the queue is 
+//full; dispatch() only calls the events queued as of its call, so slow functions can't keep it from returning; & a 
+//user function called from loop() runs with interrupts on, so the WDT keeps time while it runs
+//-------------------------------------------------------------------------------------------------------------------
+static uint32_t t_slow_func_us; //us; how long slowFunc() takes
+static void slowFunc()
+{
+  num_tick_calls++;
+  sim_consume(t_slow_func_us);
+}
+
+static void testDeferred()
+{
+  wdt.setDeferred(true);
+  numCallOrder = 0;
+  callOrder[0] = '\0';
+  byte idA = wdt.addTimer(funcA,100,_WDT_REPEAT);
+  byte idB = wdt.addTimer(funcB,150,_WDT_REPEAT);
+  sim_consume(320000); //A at 100, B at 150, A at 200, B & A at 300; interrupts are on, as in loop()
+  CHECK(numCallOrder==0); //none called by the ISR
+  WDT_event_t events[WDT_EVENT_QUEUE_SIZE];
+  byte numEvents = 0;
+  while (numEvents<WDT_EVENT_QUEUE_SIZE && wdt.poll(&events[numEvents]))
+    numEvents++;
+  CHECK(numEvents==5);
+  CHECK(events[0].timerID==idA && events[1].timerID==idB && events[2].timerID==idA);
+  CHECK(events[3].timerID!=events[4].timerID);
+  CHECK(usDiff(events[1].t_event - events[0].t_event,50) <= T_RESOLUTION && events[4].t_event==events[3].t_event);
+  CHECK(events[0].func==funcA && events[1].func==funcB);
+  
+  //A at 400 to 1300: the 7 oldest are kept, & the 3 newest dropped
+  wdt.cancelTimer(idB);
+  uint32_t overflows = wdt.eventOverflows();
+  sim_consume(1000000);
+  CHECK(wdt.eventOverflows() - overflows==3);
+  numEvents = 0;
+  while (numEvents<WDT_EVENT_QUEUE_SIZE && wdt.poll(&events[numEvents]))
+    numEvents++;
+  CHECK(numEvents==WDT_EVENT_QUEUE_SIZE - 1);
+  CHECK(usDiff(events[numEvents-1].t_event - events[0].t_event,600) <= T_RESOLUTION);
+  sim_consume(250000); //A at 1400 & 1500
+  CHECK(wdt.dispatch()==2);
+  CHECK(strcmp(callOrder,"AA")==0);
+  CHECK(wdt.dispatch()==0);
+  wdt.cancelTimer(idA);
+  
+  //a 250ms function every 100ms: the ISR queues 2 or 3 more events while dispatch() runs it, but it returns anyway
+  num_tick_calls = 0;
+  t_slow_func_us = 250000;
+  byte id = wdt.addTimer(slowFunc,100,_WDT_REPEAT);
+  sim_consume(110000);
+  CHECK(wdt.dispatch()==1);
+  CHECK(num_tick_calls==1);
+  wdt.cancelTimer(id);
+  while (wdt.poll(&events[0])) {}
+  
+  //a 600ms function on a 1000ms timer, called from loop(): no periods are lost, & now() keeps up with true time
+  num_tick_calls = 0;
+  t_slow_func_us = 600000;
+  overflows = wdt.eventOverflows();
+  CHECK(wdt.attachInterrupt(slowFunc,1000,_WDT_REPEAT));
+  uint32_t t_start = wdt.now();
+  uint64_t t_start_us = sim_now_us();
+  for (byte i=0; i<20; i++)
+  {
+    wdt.sleep();
+    wdt.dispatch();
+  }
+  CHECK(num_tick_calls==20);
+  CHECK(wdt.eventOverflows()==overflows);
+  CHECK(usDiff((uint64_t)(wdt.now() - t_start)*1000,sim_now_us() - t_start_us) < 16000);
+  CHECK(usDiff(sim_now_us() - t_start_us,20*1000000UL + t_slow_func_us) < 16000);
+  wdt.stop();
+  wdt.syncMillis();
+  wdt.setDeferred(false);
+}
+
+#if WDT_STATS
+//-------------------------------------------------------------------------------------------------------------------
+//timing statistics: from the ISR, an overrun is only counted when the user function ran through its timer's next 
+//deadline, not just past the end of the WDT delay started before it; in deferred mode, micros() times it
+//-------------------------------------------------------------------------------------------------------------------
+static void testStats()
+{
+  WDT_stats_t stats;
+  
+  //600ms on a 1000ms timer: it runs past the first WDT delay of the next period, but not past the period
+  num_tick_calls = 0;
+  t_slow_func_us = 600000;
+  CHECK(wdt.attachInterrupt(slowFunc,1000,_WDT_REPEAT));
+  wdt.setStatsTimer(_WDT_LEGACY_TIMER);
+  runFor(20500000);
+  wdt.stats(&stats);
+  CHECK(num_tick_calls > 15);
+  CHECK(stats.overruns==0);
+  wdt.stop();
+  
+  //20ms on a 16ms timer, whose every period is a single WDT delay: every call but the last one runs through the next deadline
+  num_tick_calls = 0;
+  t_slow_func_us = 20000;
+  byte id = wdt.addTimer(slowFunc,16,_WDT_REPEAT);
+  wdt.setStatsTimer(id);
+  runFor(1000000);
+  wdt.stats(&stats);
+  CHECK(stats.periods > 10);
+  CHECK(stats.overruns==stats.periods - 1);
+  wdt.cancelTimer(id);
+  
+  //deferred: 1500ms on a 1000ms timer, timed by micros()
+  wdt.setDeferred(true);
+  num_tick_calls = 0;
+  t_slow_func_us = 1500000;
+  CHECK(wdt.attachInterrupt(slowFunc,1000,_WDT_REPEAT));
+  wdt.setStatsTimer(_WDT_LEGACY_TIMER);
+  for (byte i=0; i<5; i++)
+  {
+    wdt.sleep();
+    wdt.dispatch();
+  }
+  wdt.stats(&stats);
+  CHECK(num_tick_calls>=5 && stats.overruns==num_tick_calls);
+  wdt.stop();
+  while (wdt.dispatch()>0) {}
+  wdt.setDeferred(false);
+  wdt.syncMillis();
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------
+//a user function which runs past the next WDT delay segment holds the ISR off; that's seen from the WDT's own pending
+//interrupt (Timer0 can't see it, since it stops counting too), & the deadline it ran through counts as missed; one 
+//which only runs past an earlier WDT delay of the period, not its deadline, doesn't
+//-------------------------------------------------------------------------------------------------------------------
+static void testHeldOff()
+{
+  t_slow_func_us = 10000; //10ms: on time
+  num_tick_calls = 0;
+  CHECK(wdt.attachInterrupt(slowFunc,1024,_WDT_REPEAT));
+  runFor(10*1024000UL);
+  CHECK(num_tick_calls==10);
+  CHECK(wdt.missedPeriods(_WDT_LEGACY_TIMER)==0);
+  
+  t_slow_func_us = 600000; //600ms: it runs past the first WDT delay of the next period (512ms), but not past its deadline
+  num_tick_calls = 0;
+  CHECK(wdt.attachInterrupt(slowFunc,1000,_WDT_REPEAT));
+  runFor(20*1000000UL);
+  CHECK(num_tick_calls >= 15);
+  CHECK(wdt.missedPeriods(_WDT_LEGACY_TIMER)==0);
+  
+  t_slow_func_us = 24000; //1.5 periods, each a single WDT delay (or Timer2 finish): every deadline goes by while the previous call is still running
+  num_tick_calls = 0;
+  CHECK(wdt.attachInterrupt(slowFunc,16,_WDT_REPEAT));
+  runFor(10*24000UL);
+  CHECK(num_tick_calls >= 5);
+  CHECK(wdt.missedPeriods(_WDT_LEGACY_TIMER)==num_tick_calls - 1); //all but the first call
+  CHECK(wdt.coalescedPeriods(_WDT_LEGACY_TIMER)==0); //_WDT_OVERRUN_CATCH_UP
+  wdt.stop();
+  
+  //the longest period, called a few ms early (it's rounded to the 16ms delay), isn't mistaken for one which is 2^32 ms late
+  num_tick_calls = 0;
+  CHECK(wdt.attachInterrupt(tickFunc,2147483638,_WDT_REPEAT)); //6ms more than a whole # of 16ms delays
+  runFor(2*2147483638000ULL + 1000000);
+  CHECK(num_tick_calls==2);
+  CHECK(wdt.missedPeriods(_WDT_LEGACY_TIMER)==0);
+  wdt.stop();
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//a slack of a period or more is cut down to less than half of the period, so a late call can't run past the next 
+//deadline & count it as missed
+//-------------------------------------------------------------------------------------------------------------------
+static void testSlack()
+{
+  num_tick_calls = 0;
+  CHECK(wdt.attachInterrupt(tickFunc,100,_WDT_REPEAT,1000));
+  runFor(100*100000UL);
+  CHECK(num_tick_calls>=99 && num_tick_calls<=100);
+  CHECK(wdt.missedPeriods(_WDT_LEGACY_TIMER)==0);
+  wdt.stop();
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//atTime() & everyAligned(), against a time set with setNow(): the first aligned call is on the next boundary still 
+//ahead; a time which has already gone by is called right away; & the arguments they can't do are refused
+//-------------------------------------------------------------------------------------------------------------------
+static void testAligned()
+{
+  wdt.setNow(7000000000ULL + 1234 + 500); //500ms past a 7000ms boundary (+1234), & past 2^32
+  uint64_t t_start64 = wdt.now64();
+  CHECK(t_start64 - 7000000000ULL - 1234 - 500 < 2);
+  num_aligned_calls = 0;
+  num_aligned_misaligned = 0;
+  byte alignedID = wdt.everyAligned(alignedFunc,7000,1234);
+  CHECK(alignedID!=_WDT_NO_TIMER);
+  runFor(21000000); //to 500ms past the 3rd boundary after the start
+  CHECK(num_aligned_calls==3);
+  CHECK(num_aligned_misaligned==0);
+  CHECK(t_aligned_first64 + T_RESOLUTION >= t_start64 - 500 + 7000 && t_aligned_first64 <= t_start64 - 500 + 7000 + T_RESOLUTION);
+  CHECK(wdt.cancelTimer(alignedID));
+  
+  //already gone by: called on the next WDT interrupt
+  t_at_called64 = 0;
+  uint64_t t_at64 = wdt.now64() - 1000;
+  CHECK(wdt.atTime(atFunc,t_at64)!=_WDT_NO_TIMER);
+  runFor(100000);
+  CHECK(t_at_called64!=0 && t_at_called64 <= t_at64 + 1000 + 16 + T_RESOLUTION);
+  
+  CHECK(wdt.atTime(atFunc,wdt.now64() + 0x80000000ULL)==_WDT_NO_TIMER); //more than 2^31-1 ms away
+  CHECK(wdt.everyAligned(alignedFunc,1000,1000)==_WDT_NO_TIMER); //phase must be < period
+  CHECK(wdt.everyAligned(alignedFunc,1000,-1)==_WDT_NO_TIMER);
+  CHECK(wdt.everyAligned(alignedFunc,0,0)==_WDT_NO_TIMER);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//supervision mode: no reset while every supervised task checks in once per window; once one stops, the WDT resets the
+//mcu at the end of the window, & stalledTasks() says which one it was, until beginSupervision() is called again; & a
+//long user function called from the ISR resets it too, by holding the WDT interrupt off past the next time-out
+//-------------------------------------------------------------------------------------------------------------------
+static boolean task2_alive;
+static void checkInFunc()
+{
+  wdt.checkIn(0);
+  if (task2_alive)
+    wdt.checkIn(2);
+  wdt.checkIn(WDT_MAX_TASKS + 100); //not a task; ignored
+}
+
+static void testSupervision()
+{
+  unsigned long resets_start = sim_wdtResets();
+  task2_alive = true;
+  byte checkInID = wdt.addTimer(checkInFunc,100,_WDT_REPEAT);
+  CHECK(checkInID!=_WDT_NO_TIMER);
+  CHECK(wdt.beginSupervision(0x05,500)); //tasks 0 & 2
+  CHECK(wdt.stalledTasks()==0);
+  runFor(3000000);
+  CHECK(sim_wdtResets()==resets_start);
+  
+  task2_alive = false;
+  runFor(1500000);
+  CHECK(sim_wdtResets()==resets_start + 1);
+  CHECK(wdt.stalledTasks()==0x04);
+  
+  //the mcu starts over; the record survives that, until supervision starts again
+  wdt.cancelTimer(checkInID);
+  wdt.stopSupervision();
+  CHECK(wdt.stalledTasks()==0x04);
+  CHECK(wdt.beginSupervision(0x01,500));
+  CHECK(wdt.stalledTasks()==0);
+  wdt.stopSupervision();
+  CHECK(sim_wdtResets()==resets_start + 1);
+  
+  //a user function called from the ISR which holds the WDT interrupt off past the next time-out resets the mcu too, 
+  //even though every task checks in...
+  task2_alive = true;
+  t_slow_func_us = 600000;
+  num_tick_calls = 0;
+  checkInID = wdt.addTimer(checkInFunc,100,_WDT_REPEAT);
+  CHECK(wdt.beginSupervision(0x05,2000));
+  wdt.addTimer(slowFunc,1000);
+  runFor(3000000);
+  CHECK(num_tick_calls==1);
+  CHECK(sim_wdtResets()==resets_start + 2);
+  CHECK(wdt.stalledTasks()==0);
+  wdt.cancelTimer(checkInID);
+  wdt.stopSupervision();
+  
+  //...but not when it's called from loop(), in deferred mode
+  wdt.setDeferred(true);
+  num_tick_calls = 0;
+  checkInID = wdt.addTimer(checkInFunc,100,_WDT_REPEAT);
+  CHECK(wdt.beginSupervision(0x05,2000));
+  wdt.addTimer(slowFunc,1000);
+  uint64_t t_end_us = sim_now_us() + 3000000;
+  while (sim_now_us() < t_end_us)
+  {
+    wdt.sleep();
+    wdt.dispatch();
+  }
+  CHECK(num_tick_calls==1);
+  CHECK(sim_wdtResets()==resets_start + 2);
+  wdt.cancelTimer(checkInID);
+  wdt.stopSupervision();
+  while (wdt.dispatch()>0) {}
+  wdt.setDeferred(false);
+  wdt.syncMillis();
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+//snapshot(): the attachInterrupt() timer's state, from loop() & from within its own user function
+//-------------------------------------------------------------------------------------------------------------------
+static WDT_state_t funcState;
+static uint32_t t_funcNow;
+static void snapshotFunc()
+{
+  wdt.snapshot(&funcState);
+  t_funcNow = wdt.now();
+}
+
+static void testSnapshot()
+{
+  WDT_state_t state;
+  wdt.snapshot(&state);
+  byte calls_start = state.userFuncCalls;
+  CHECK(wdt.attachInterrupt(snapshotFunc,1000,_WDT_REPEAT));
+  runFor(3500000);
+  wdt.snapshot(&state);
+  CHECK(state.t_WDT_delay_desired==1000);
+  CHECK(state.WDT_mode==_WDT_REPEAT);
+  CHECK((byte)(state.userFuncCalls - calls_start)==3);
+  CHECK(state.t_WDT_delay_actual >= 1000 - T_RESOLUTION && state.t_WDT_delay_actual <= 1000 + T_RESOLUTION);
+  CHECK(labs((int32_t)(state.t_WDT_end - state.t_WDT_start)) <= T_RESOLUTION); //last called on the deadline which started this period
+  CHECK(state.t_WDT_delay_remaining > 0 && state.t_WDT_delay_remaining <= 1000 - 500 + T_RESOLUTION);
+  
+  //the user function sees its own call already counted, & the time it was called at
+  CHECK(funcState.userFuncCalls==state.userFuncCalls);
+  CHECK(funcState.t_WDT_end==t_funcNow);
+  CHECK(funcState.t_WDT_end==state.t_WDT_end);
+  wdt.stop();
+}
+
+#if WDT_SAMPLER
+//-------------------------------------------------------------------------------------------------------------------
+//the sampler: one sample per period, of the right channel, at the right time (the simulated input is the time itself);
+//a batch at a time, to the batch handler, readBatch() & sleep(); & a batch which isn't read is counted as overwritten
+//-------------------------------------------------------------------------------------------------------------------
+#define SAMPLER_CHANNEL 3
+#define SAMPLER_PERIOD 50 //ms
+#define SAMPLER_BATCH 4
+
+static unsigned int samplerSignal(byte channel,uint64_t t_us)
+{
+  if (channel!=SAMPLER_CHANNEL)
+    return 0;
+  return (unsigned int)((t_us/1000) & 0x3FF); //ms, mod 1024, like a 10-bit ADC reading
+}
+
+static uint32_t num_batch_calls;
+static void batchFunc()
+{
+  num_batch_calls++;
+}
+
+//true if each sample in the batch was taken SAMPLER_PERIOD after the one before it
+static boolean batchEvenlySpaced(const unsigned int* batch)
+{
+  for (byte i=1; i<SAMPLER_BATCH; i++)
+  {
+    int t_diff = (int)((batch[i] - batch[i - 1]) & 0x3FF); //ms
+    if (abs(t_diff - SAMPLER_PERIOD) > 2*T_RESOLUTION)
+      return false;
+  }
+  return true;
+}
+
+static void testSampler()
+{
+  static unsigned int buffer[2*SAMPLER_BATCH];
+  sim_setAdcSignal(samplerSignal);
+  num_batch_calls = 0;
+  unsigned long adc_start = sim_adcInterrupts();
+  CHECK(wdt.beginSampler(SAMPLER_CHANNEL,SAMPLER_PERIOD,buffer,0,batchFunc)==_WDT_NO_TIMER);
+  byte samplerID = wdt.beginSampler(SAMPLER_CHANNEL,SAMPLER_PERIOD,buffer,SAMPLER_BATCH,batchFunc);
+  CHECK(samplerID!=_WDT_NO_TIMER);
+  
+  //awake: each conversion starts right away; 5 batches, of which only the last one is read
+  runFor(5*SAMPLER_BATCH*SAMPLER_PERIOD*1000UL + SAMPLER_PERIOD*1000UL/2);
+  CHECK(sim_adcInterrupts() - adc_start==5*SAMPLER_BATCH);
+  CHECK(num_batch_calls==5);
+  CHECK(wdt.batchOverruns()==4);
+  const unsigned int* batch = wdt.readBatch();
+  CHECK(batch!=NULL && batchEvenlySpaced(batch));
+  CHECK(batch!=NULL && (unsigned int)((sim_now_us()/1000 - batch[SAMPLER_BATCH - 1]) & 0x3FF) <= SAMPLER_PERIOD); //the latest one
+  CHECK(wdt.readBatch()==NULL); //no new one since
+  
+  //asleep: each conversion runs in SLEEP_MODE_ADC, & sleep() only returns once per batch
+  uint64_t t_asleep_start_us = sim_asleep_us();
+  for (byte i=0; i<3; i++)
+  {
+    unsigned long adc_before = sim_adcInterrupts();
+    wdt.sleep();
+    CHECK(sim_adcInterrupts() - adc_before==SAMPLER_BATCH);
+    batch = wdt.readBatch();
+    CHECK(batch!=NULL && batchEvenlySpaced(batch));
+  }
+  CHECK(num_batch_calls==8);
+  CHECK(wdt.batchOverruns()==4);
+  CHECK(sim_asleep_us() - t_asleep_start_us > 3*(SAMPLER_BATCH - 1)*SAMPLER_PERIOD*1000UL);
+  wdt.syncMillis(); //millis() stopped while asleep
+  
+  //stopped: no more samples
+  wdt.stopSampler();
+  unsigned long adc_stop = sim_adcInterrupts();
+  runFor(10*SAMPLER_PERIOD*1000UL);
+  CHECK(sim_adcInterrupts()==adc_stop);
+  sim_setAdcSignal(NULL);
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------
+//the time base: the WDT delays calibrate themselves against the crystal as they run, so now() keeps up with true time 
+//even with the WDT oscillator off by ~0.8%; the ISR never reads millis() (in either the heap or the WDTimer<> path); 
+//& millis() catches back up with now() after power-down sleep, with syncMillis()
+//-run last, since it leaves the simulated WDT oscillator off
+//-------------------------------------------------------------------------------------------------------------------
+static WDTimer<1000> chainTimer;
+
+static void testTimeBase()
+{
+  sim_setOscillatorDrift(-0.008); //the WDT runs 0.8% fast from here on, as if the temperature had changed...
+  wdt.setBackgroundCalibration(_WDT_CAL_AUTO); //...a lot, so start the calibration over
+  num_tick_calls = 0;
+  CHECK(wdt.attachInterrupt(tickFunc,1000,_WDT_REPEAT));
+  uint32_t t_start = wdt.now();
+  uint64_t t_start_us = sim_now_us();
+  unsigned long millisReads_start = sim_millisReads();
+  runFor(3600000000ULL); //1 hour
+  CHECK(sim_millisReads()==millisReads_start);
+  CHECK(usDiff((uint64_t)(wdt.now() - t_start)*1000,sim_now_us() - t_start_us) < 2000);
+  CHECK(num_tick_calls>=3599 && num_tick_calls<=3600);
+  
+  //an estimate of how far along the current segment is, for now() read between two WDT interrupts
+  t_start = wdt.now();
+  t_start_us = sim_now_us();
+  sim_consume(300000); //within the first WDT delay of the period
+  CHECK(usDiff((uint64_t)(wdt.now() - t_start)*1000,sim_now_us() - t_start_us) < 2000);
+  wdt.stop();
+  
+  //the same for a WDTimer<PeriodMs>
+  num_tick_calls = 0;
+  chainTimer.begin(tickFunc);
+  t_start = wdt.now();
+  t_start_us = sim_now_us();
+  millisReads_start = sim_millisReads();
+  runFor(600000000ULL); //10 minutes
+  CHECK(sim_millisReads()==millisReads_start);
+  CHECK(usDiff((uint64_t)(wdt.now() - t_start)*1000,sim_now_us() - t_start_us) < 2000);
+  chainTimer.stop();
+  
+  //power-down sleep stops millis(), until syncMillis()
+  CHECK(wdt.attachInterrupt(tickFunc,1000,_WDT_REPEAT));
+  t_start = wdt.now();
+  uint32_t t_start_ms = millis();
+  for (byte i=0; i<10; i++)
+    wdt.sleep();
+  uint32_t t_slept = wdt.now() - t_start; //ms
+  CHECK(t_slept>=9990 && t_slept<=10010);
+  CHECK(millis() - t_start_ms < t_slept/2);
+  wdt.syncMillis();
+  CHECK(labs((int32_t)(millis() - t_start_ms) - (int32_t)t_slept) <= 2);
+  wdt.stop();
+}
+
+int main()
+{
+  beginNominal();
+  printf("addTimer() & cancelTimer()\n");
+  testTimers();
+  printf("Timer0 held off by interrupts being off\n");
+  testTimer0HeldOff();
+  printf("32-bit roll-overs\n");
+  testRollOver();
+  printf("sleep() & the duty cycle\n");
+  testSleep();
+  printf("WDTimer<PeriodMs>\n");
+  testChain();
+#if WDT_FINE
+  printf("fine mode\n");
+  testFine();
+#endif
+  printf("calibration record\n");
+  testCalibrationRecord();
+  printf("deferred mode\n");
+  testDeferred();
+#if WDT_STATS
+  printf("timing statistics\n");
+  testStats();
+#endif
+  printf("WDT ISR held off by a user function\n");
+  testHeldOff();
+  printf("slack\n");
+  testSlack();
+  printf("atTime() & everyAligned()\n");
+  testAligned();
+  printf("supervision mode\n");
+  testSupervision();
+  printf("snapshot()\n");
+  testSnapshot();
+#if WDT_SAMPLER
+  printf("sampler\n");
+  testSampler();
+#endif
+  printf("time base\n");
+  testTimeBase();
+
+  printf("%u checks, %u failed\n",num_checks,num_failures);
+  return (num_failures > 255) ? 255 : (int)num_failures;
+}